@@ -0,0 +1,707 @@
+pragma ComponentBehavior: Bound
+
+import QtQuick
+import QtQuick.Controls 2.15 as QQC
+import QtQuick.Layouts
+import QtQuick.Dialogs
+import org.mauikit.controls as Maui
+import org.nitrux.firewall 1.0
+
+Maui.ApplicationWindow {
+    id: root
+
+    readonly property string statusText: backend.state === "running"
+        ? (backend.panic ? qsTr("Lockdown") : "")
+        : qsTr("Error")
+
+    // The zone being viewed and edited; not necessarily the default one
+    readonly property string currentZone: backend.currentZone
+
+    readonly property string profileText: currentZone.length > 0
+                                          ? zoneLabel(currentZone)
+                                          : qsTr("No Profile")
+
+    function zoneLabel(zone: string): string {
+        return zone.length > 0 ? zone.charAt(0).toUpperCase() + zone.slice(1) : zone
+    }
+
+    title: "Zone — " + profileText + (statusText ? " (" + statusText + ")" : "")
+
+    color: "transparent"
+    background: null
+
+    FirewallBackend {
+        id: backend
+        onOperationError: (error) => {
+            console.warn("Firewall Error: " + error)
+        }
+
+        // refresh() is asynchronous, so follow the viewed zone once it arrives
+        onCurrentZoneChanged: profileCombo.currentIndex = backend.zones.indexOf(backend.currentZone)
+        onZonesChanged: profileCombo.currentIndex = backend.zones.indexOf(backend.currentZone)
+
+        onImportProgress: (progress) => {
+            importBar.value = progress.stage === "uploading"
+                ? (progress.toUpload > 0 ? progress.uploaded / progress.toUpload : 0)
+                : (progress.bytesTotal > 0 ? progress.bytesRead / progress.bytesTotal : 0)
+            importStatus.text = progress.stage === "reading"
+                ? qsTr("Reading: %1 lines, %2 lines/s").arg(progress.lines).arg(progress.linesPerSecond)
+                : progress.stage === "uploading"
+                  ? qsTr("Uploading %1 of %2 entries (%3 invalid lines skipped)").arg(progress.uploaded).arg(progress.toUpload).arg(progress.invalid)
+                  : qsTr("Reloading firewall")
+        }
+        onImportFinished: (result) => {
+            importStatus.text = result.ok
+                ? qsTr("Imported %1 addresses as %2 entries").arg(result.accepted).arg(result.entries)
+                : qsTr("Import failed: %1").arg(result.message)
+        }
+
+        onPolicyApplied: (result) => {
+            if (!result.ok) console.warn("Policy apply failed: " + JSON.stringify(result.errors))
+            else if (result.zones.length === 0 && result.globals.length === 0) console.info("Policy already in effect")
+        }
+    }
+
+    FileDialog {
+        id: importDialog
+        title: qsTr("Import Sources")
+        nameFilters: [qsTr("Address lists (*.txt *.list *.netset *.ipset)"), qsTr("All files (*)")]
+        onAccepted: backend.importSources(selectedFile, "cinderward-" + root.currentZone, root.currentZone)
+    }
+
+    FileDialog {
+        id: exportPolicyDialog
+        title: qsTr("Export Policy")
+        fileMode: FileDialog.SaveFile
+        defaultSuffix: "json"
+        nameFilters: [qsTr("Policy files (*.json)")]
+        onAccepted: backend.savePolicy(selectedFile)
+    }
+
+    FileDialog {
+        id: applyPolicyDialog
+        title: qsTr("Apply Policy")
+        nameFilters: [qsTr("Policy files (*.json)"), qsTr("All files (*)")]
+        onAccepted: backend.loadPolicy(selectedFile)
+    }
+
+    FileDialog {
+        id: exportTraceDialog
+        title: qsTr("Export D-Bus Trace")
+        fileMode: FileDialog.SaveFile
+        defaultSuffix: "json"
+        nameFilters: [qsTr("Trace files (*.json)")]
+        onAccepted: backend.exportTrace(selectedFile)
+    }
+
+    // Per-method firewalld latency, to tell which call makes the app feel stuck
+    Maui.PopupPage {
+        id: diagnosticsDialog
+        title: qsTr("Diagnostics")
+        persistent: false
+
+        // The numbers are pulled from the backend only while this is open
+        Timer {
+            interval: 1000
+            repeat: true
+            triggeredOnStart: true
+            running: diagnosticsDialog.visible
+            onTriggered: backend.callStats.update()
+        }
+
+        headBar.rightContent: QQC.Button {
+            text: qsTr("Export Trace…")
+            icon.name: "document-export"
+            onClicked: exportTraceDialog.open()
+        }
+
+        QQC.Label {
+            Layout.fillWidth: true
+            opacity: 0.7
+            text: qsTr("%1 calls, %2 failed. Latencies in milliseconds.")
+                  .arg(backend.callStats.totalCalls).arg(backend.callStats.totalErrors)
+        }
+
+        ListView {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 360
+            clip: true
+            model: backend.callStats
+
+            header: RowLayout {
+                width: ListView.view.width
+                QQC.Label { Layout.fillWidth: true; text: qsTr("Method"); font.weight: Font.DemiBold }
+                QQC.Label { Layout.preferredWidth: 60; text: qsTr("Calls"); font.weight: Font.DemiBold; horizontalAlignment: Text.AlignRight }
+                QQC.Label { Layout.preferredWidth: 60; text: qsTr("p50"); font.weight: Font.DemiBold; horizontalAlignment: Text.AlignRight }
+                QQC.Label { Layout.preferredWidth: 60; text: qsTr("p99"); font.weight: Font.DemiBold; horizontalAlignment: Text.AlignRight }
+                QQC.Label { Layout.preferredWidth: 60; text: qsTr("Max"); font.weight: Font.DemiBold; horizontalAlignment: Text.AlignRight }
+            }
+
+            delegate: RowLayout {
+                id: statsRow
+                required property string method
+                required property int calls
+                required property int errors
+                required property real p50
+                required property real p99
+                required property real max
+
+                width: ListView.view.width
+                QQC.Label {
+                    Layout.fillWidth: true
+                    elide: Text.ElideRight
+                    text: statsRow.errors > 0 ? qsTr("%1 (%2 failed)").arg(statsRow.method).arg(statsRow.errors) : statsRow.method
+                    color: statsRow.errors > 0 ? Maui.Theme.negativeTextColor : Maui.Theme.textColor
+                }
+                QQC.Label { Layout.preferredWidth: 60; text: statsRow.calls; horizontalAlignment: Text.AlignRight }
+                QQC.Label { Layout.preferredWidth: 60; text: statsRow.p50.toFixed(1); horizontalAlignment: Text.AlignRight }
+                QQC.Label { Layout.preferredWidth: 60; text: statsRow.p99.toFixed(1); horizontalAlignment: Text.AlignRight }
+                QQC.Label { Layout.preferredWidth: 60; text: statsRow.max.toFixed(1); horizontalAlignment: Text.AlignRight }
+            }
+        }
+    }
+
+    // What denied-packet logging catches, summarized so a port scan stays readable
+    Maui.PopupPage {
+        id: deniedLogDialog
+        title: qsTr("Denied Packets")
+        persistent: false
+
+        // Reading starts on first open; the list is only refreshed while this is open
+        Binding {
+            target: backend.deniedLog
+            property: "active"
+            value: deniedLogDialog.visible
+        }
+
+        headBar.rightContent: QQC.Button {
+            text: qsTr("Clear")
+            icon.name: "edit-clear-history"
+            onClicked: backend.deniedLog.clear()
+        }
+
+        QQC.Label {
+            Layout.fillWidth: true
+            opacity: 0.7
+            wrapMode: Text.Wrap
+            text: backend.deniedLog.error.length > 0
+                  ? qsTr("Cannot read the kernel log: %1").arg(backend.deniedLog.error)
+                  : !backend.logDenied
+                    ? qsTr("Denied-packet logging is off; turn it on to see packets here.")
+                    : qsTr("%1 denied, %2 log lines/s.").arg(backend.deniedLog.totalDenied)
+                                                         .arg(backend.deniedLog.linesPerSecond.toFixed(0))
+        }
+
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Maui.Style.space.big
+
+            Repeater {
+                model: [
+                    { title: qsTr("Top Sources"), items: backend.deniedLog.topSources },
+                    { title: qsTr("Top Ports"), items: backend.deniedLog.topPorts },
+                    { title: qsTr("Top Zones"), items: backend.deniedLog.topZones }
+                ]
+
+                delegate: ColumnLayout {
+                    id: topColumn
+                    required property var modelData
+
+                    Layout.fillWidth: true
+                    Layout.alignment: Qt.AlignTop
+
+                    QQC.Label { text: topColumn.modelData.title; font.weight: Font.DemiBold }
+
+                    Repeater {
+                        model: topColumn.modelData.items
+                        delegate: RowLayout {
+                            id: topRow
+                            required property var modelData
+
+                            Layout.fillWidth: true
+                            QQC.Label { Layout.fillWidth: true; elide: Text.ElideRight; text: topRow.modelData.key }
+                            QQC.Label { text: topRow.modelData.count; horizontalAlignment: Text.AlignRight }
+                        }
+                    }
+                }
+            }
+        }
+
+        ListView {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 300
+            clip: true
+            model: backend.deniedLog
+
+            delegate: QQC.Label {
+                required property date time
+                required property string zone
+                required property string chain
+                required property string action
+                required property string source
+                required property string protocol
+                required property int destinationPort
+
+                width: ListView.view.width
+                elide: Text.ElideRight
+                text: qsTr("%1  %2 %3  %4 → %5  %6").arg(Qt.formatTime(time, "hh:mm:ss"))
+                      .arg(zone.length > 0 ? zone : chain).arg(action)
+                      .arg(source)
+                      .arg(destinationPort > 0 ? destinationPort : "")
+                      .arg(protocol.toLowerCase())
+            }
+        }
+    }
+
+    Maui.WindowBlur {
+        view: root
+        geometry: Qt.rect(0, 0, root.width, root.height)
+        windowRadius: Maui.Style.radiusV
+        enabled: true
+    }
+
+    Rectangle {
+        anchors.fill: parent
+        color: Maui.Theme.backgroundColor
+        opacity: 0.76
+        radius: Maui.Style.radiusV
+        border.color: Qt.rgba(1, 1, 1, 0)
+        border.width: 1
+    }
+
+    Maui.Page {
+        anchors.fill: parent
+        flickable: scrollColumn.flickable
+        background: null
+        headerMargins: Maui.Style.contentMargins
+
+        Component.onCompleted: backend.refresh("")
+
+        headBar.leftContent: [
+            QQC.Label {
+                text: qsTr("Profile")
+                font.weight: Font.DemiBold
+                verticalAlignment: Text.AlignVCenter
+            },
+            QQC.ComboBox {
+                id: profileCombo
+                implicitWidth: 200
+                currentIndex: -1
+                displayText: currentIndex === -1 ? qsTr("Select Profile") : root.zoneLabel(currentText)
+                model: backend.zones
+                onActivated: (index) => backend.viewZone(backend.zones[index])
+                // The backend may already hold the cached state when this is created
+                Component.onCompleted: currentIndex = backend.zones.indexOf(backend.currentZone)
+
+                delegate: QQC.ItemDelegate {
+                    required property string modelData
+                    required property int index
+
+                    width: ListView.view.width
+                    text: root.zoneLabel(modelData) + (modelData === backend.defaultZone ? " " + qsTr("(Default)") : "")
+                    highlighted: profileCombo.highlightedIndex === index
+                }
+            },
+            QQC.ToolButton {
+                icon.name: root.currentZone === backend.defaultZone ? "starred" : "non-starred"
+                enabled: root.currentZone.length > 0 && root.currentZone !== backend.defaultZone
+                onClicked: backend.changeDefaultZone(root.currentZone)
+
+                QQC.ToolTip {
+                    visible: parent.hovered
+                    text: qsTr("Use this profile as the default zone.")
+                    delay: 500
+                }
+            }
+        ]
+
+        headBar.rightContent: [
+            // 0. Shown while a refresh is in flight
+            QQC.BusyIndicator {
+                running: backend.busy
+                visible: running
+                implicitWidth: Maui.Style.iconSizes.medium
+                implicitHeight: Maui.Style.iconSizes.medium
+            },
+
+            // 1. The Lockdown Switch (Existing)
+            QQC.Switch {
+                text: backend.panic ? qsTr("Disable Lockdown") : qsTr("Enable Lockdown")
+                checked: backend.panic
+                onClicked: backend.setPanic(!backend.panic)
+
+                QQC.ToolTip {
+                    visible: parent.hovered
+                    text: qsTr("Immediately block all incoming and outgoing connections.")
+                    delay: 500
+                }
+            },
+
+            // 2. The Separator
+            QQC.ToolSeparator {
+                bottomPadding: 10
+                topPadding: 10
+            },
+
+            // 3. The Menu
+            Maui.ToolButtonMenu {
+                icon.name: "overflow-menu"
+
+                QQC.MenuItem {
+                    text: qsTr("Export Policy…")
+                    icon.name: "document-export"
+                    onTriggered: exportPolicyDialog.open()
+                }
+
+                QQC.MenuItem {
+                    text: qsTr("Apply Policy…")
+                    icon.name: "document-import"
+                    enabled: !backend.batchActive
+                    onTriggered: applyPolicyDialog.open()
+                }
+
+                QQC.MenuItem {
+                    text: qsTr("Denied Packets")
+                    icon.name: "security-low"
+                    onTriggered: deniedLogDialog.open()
+                }
+
+                QQC.MenuItem {
+                    text: qsTr("Diagnostics")
+                    icon.name: "view-statistics"
+                    onTriggered: diagnosticsDialog.open()
+                }
+
+                QQC.MenuItem {
+                    text: qsTr("About")
+                    icon.name: "documentinfo"
+                    onTriggered: Maui.App.aboutDialog()
+                }
+            }
+        ]
+        
+        Maui.ScrollColumn {
+            id: scrollColumn
+            anchors.fill: parent
+            spacing: Maui.Style.space.big
+
+            Maui.SectionHeader {
+                Layout.fillWidth: true
+                text1: qsTr("Zone Configuration")
+                text2: qsTr("Manage global switches and add traffic rules.")
+            }
+
+            Maui.FlexSectionItem {
+                label1.text: qsTr("Masquerading")
+                label2.text: qsTr("Enable Network Address Translation (NAT) for outbound traffic.")
+
+                QQC.Switch {
+                    checked: backend.masquerade
+                    onToggled: backend.setMasquerade(checked, root.currentZone)
+                }
+            }
+
+            Maui.FlexSectionItem {
+                label1.text: qsTr("Stealth Mode")
+                label2.text: qsTr("Silently drop all uninvited packets (Target: DROP).")
+                QQC.Switch {
+                    checked: backend.stealthMode
+                    onToggled: backend.setStealthMode(checked, root.currentZone)
+                }
+            }
+
+            Maui.FlexSectionItem {
+                label1.text: qsTr("Strict ICMP")
+                label2.text: qsTr("Allow critical ICMP types required for a healthy connection, while still blocking everything else.")
+                QQC.Switch {        
+                    checked: backend.strictIcmp
+                    onToggled: backend.setStrictIcmp(checked, root.currentZone)
+                }
+            }
+
+            Maui.FlexSectionItem {
+                label1.text: qsTr("Log Denied")
+                label2.text: qsTr("Control logging for packets that are rejected or dropped.")
+
+                QQC.Switch {
+                    checked: backend.logDenied
+                    onToggled: backend.setLogDenied(checked)
+                }
+            }
+
+            Maui.SectionGroup {
+                title: qsTr("Services")
+                description: qsTr("Allow predefined network services.")
+
+                Maui.TextField {
+                    Layout.fillWidth: true
+                    placeholderText: qsTr("Search by name or port (e.g. ssh, 5432/tcp)")
+                    onTextChanged: backend.serviceCatalog.filter = text
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    QQC.ComboBox {
+                        id: serviceCombo
+                        Layout.fillWidth: true
+                        model: backend.serviceCatalog
+                        textRole: "name"
+
+                        delegate: QQC.ItemDelegate {
+                            required property string name
+                            required property string ports
+                            required property int index
+
+                            width: ListView.view.width
+                            text: ports.length > 0 ? name + "  (" + ports + ")" : name
+                            highlighted: serviceCombo.highlightedIndex === index
+                        }
+                    }
+
+                    QQC.Button {
+                        Layout.fillWidth: false
+                        display: QQC.AbstractButton.IconOnly
+                        icon.name: "list-add"
+
+                        onClicked: {
+                            backend.addService(serviceCombo.currentText, root.currentZone)
+                        }
+                    }
+                }
+            }
+
+            Maui.SectionGroup {
+                Layout.fillWidth: true
+                title: qsTr("Ports")
+                description: qsTr("Manually open specific ports.")
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    Maui.TextField {
+                        id: portText
+                        Layout.fillWidth: true
+                        placeholderText: qsTr("Port (e.g. 8080)")
+                        inputMethodHints: Qt.ImhDigitsOnly
+                    }
+
+                    QQC.ComboBox {
+                        id: protocolCombo
+                        Layout.preferredWidth: 100
+                        model: ["TCP", "UDP"]
+                    }
+
+                    QQC.Button {
+                        display: QQC.AbstractButton.IconOnly
+                        icon.name: "list-add"
+
+                        onClicked: {
+                            backend.addPort(portText.text,
+                                            protocolCombo.currentText.toLowerCase(),
+                                            root.currentZone)
+                            portText.text = ""
+                        }
+                    }
+                }
+
+                // Answered from the port index while typing
+                QQC.Label {
+                    readonly property var reasons: backend.configRevision >= 0 && portText.text.length > 0
+                        ? backend.explainPort(portText.text, protocolCombo.currentText)
+                        : []
+
+                    Layout.fillWidth: true
+                    visible: reasons.length > 0
+                    wrapMode: Text.WordWrap
+                    opacity: 0.7
+                    text: reasons.length > 0
+                        ? qsTr("Already open: %1").arg(reasons.map(r => qsTr("%1 %2 in %3").arg(r.kind).arg(r.item).arg(r.zone)).join(", "))
+                        : ""
+                }
+            }
+
+            Maui.SectionGroup {
+                Layout.fillWidth: true
+                title: qsTr("Sources")
+                description: qsTr("Trust traffic from specific IPs/Subnets.")
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    Maui.TextField {
+                        id: sourceText
+                        Layout.fillWidth: true
+                        placeholderText: qsTr("IP or CIDR (e.g. 192.168.1.5)")
+                    }
+
+                    QQC.Button {
+                        display: QQC.AbstractButton.IconOnly
+                        icon.name: "list-add"
+
+                        onClicked: {
+                            backend.addSource(sourceText.text, root.currentZone)
+                            sourceText.text = ""
+                        }
+                    }
+                }
+
+                // Large lists go into an ipset instead of one source per address
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    QQC.Label {
+                        id: importStatus
+                        Layout.fillWidth: true
+                        elide: Text.ElideRight
+                        opacity: 0.7
+                        text: qsTr("Import a blocklist or allowlist file.")
+                    }
+
+                    QQC.Button {
+                        text: qsTr("Import…")
+                        enabled: !backend.importing && root.currentZone.length > 0
+                        onClicked: importDialog.open()
+                    }
+                }
+
+                QQC.ProgressBar {
+                    id: importBar
+                    Layout.fillWidth: true
+                    visible: backend.importing
+                }
+            }
+
+            Maui.SectionGroup {
+                Layout.fillWidth: true
+                title: qsTr("Port Forwarding")
+                description: qsTr("Redirect network traffic from one port to another port.")
+
+                GridLayout {
+                    Layout.fillWidth: true
+                    columns: 2
+                    rowSpacing: 10
+                    columnSpacing: 10
+
+                    Maui.TextField {
+                        id: sourcePortText
+                        Layout.fillWidth: true
+                        placeholderText: qsTr("Source Port")
+                    }
+
+                    QQC.ComboBox {
+                        id: forwardProtocolCombo
+                        Layout.fillWidth: true
+                        model: ["TCP", "UDP"]
+                    }
+
+                    Maui.TextField {
+                        id: destPortText
+                        Layout.fillWidth: true
+                        placeholderText: qsTr("Dest Port")
+                    }
+
+                    Maui.TextField {
+                        id: destIPText
+                        Layout.fillWidth: true
+                        placeholderText: qsTr("Dest IP (Optional)")
+                    }
+
+                    QQC.Button {
+                        Layout.columnSpan: 2
+                        Layout.alignment: Qt.AlignRight
+                        icon.name: "list-add"
+
+                        onClicked: {
+                            backend.addForwardRule(
+                                sourcePortText.text,
+                                forwardProtocolCombo.currentText.toLowerCase(),
+                                destPortText.text,
+                                destIPText.text,
+                                root.currentZone
+                            )
+                            sourcePortText.text = ""
+                            destPortText.text = ""
+                            destIPText.text = ""
+                        }
+                    }
+                }
+            }
+
+            Maui.SectionHeader {
+                Layout.fillWidth: true
+                readonly property var redundant: backend.configRevision >= 0 ? backend.redundantPorts(root.currentZone) : []
+
+                text1: qsTr("Active Rules")
+                text2: redundant.length > 0
+                    ? qsTr("%n port(s) already opened by another rule: ", "", redundant.length)
+                      + redundant.map(r => r.item + " (" + r.coveredBy.item + ")").join(", ")
+                    : qsTr("Current rules configured for this profile.")
+            }
+
+            Maui.ListBrowser {
+                id: listBrowser
+                Layout.fillWidth: true
+                Layout.preferredHeight: 300
+                clip: true
+
+                // Updated row by row, so unchanged delegates survive a refresh
+                model: backend.rules
+
+                holder.visible: count === 0
+                holder.emoji: "preferences-system-network-connection"
+                holder.title: qsTr("Active Rules")
+                holder.body: qsTr("No rules configured for this profile.")
+
+                delegate: Maui.ListDelegate {
+                    id: ruleDelegate
+                    required property string kind
+                    required property string value
+                    required property string port
+                    required property string protocol
+                    required property string toPort
+                    required property string toAddr
+                    required property string source
+                    required property var listening // undefined where there is no telling
+                    required property string listeners
+
+                    width: ListView.view.width
+
+                    iconName: kind === "service" ? "applications-other" :
+                              kind === "port" ? "network-wired" :
+                              kind === "source" ? "preferences-system-network" :
+                              "preferences-system-network-sharing"
+
+                    label: listening === undefined ? value
+                         : listening ? qsTr("%1 — listening by %2").arg(value).arg(listeners)
+                         : qsTr("%1 — nothing listening").arg(value)
+
+                    QQC.Button {
+                        anchors.right: parent.right
+                        anchors.verticalCenter: parent.verticalCenter
+                        icon.name: "edit-delete"
+
+                        onClicked: {
+                            const zone = root.currentZone
+                            const rule = ruleDelegate
+
+                            if (rule.kind === "service") {
+                                backend.removeService(rule.value, zone)
+                            } else if (rule.kind === "port") {
+                                backend.removePort(rule.port, rule.protocol, zone)
+                            } else if (rule.kind === "source") {
+                                backend.removeSource(rule.source, zone)
+                            } else if (rule.kind === "forward") {
+                                backend.removeForwardRule(rule.port, rule.protocol, rule.toPort, rule.toAddr, zone)
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#include "callstatsmodel.h"
+
+#include <utility>
+
+CallStatsModel::CallStatsModel(const CallTrace *trace, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_trace(trace)
+{
+}
+
+int CallStatsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_stats.size();
+}
+
+QVariant CallStatsModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid)) return QVariant();
+
+    const CallTrace::MethodStats &stats = m_stats.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case MethodRole: return stats.method;
+    case CallsRole: return qulonglong(stats.calls);
+    case ErrorsRole: return qulonglong(stats.errors);
+    case P50Role: return stats.p50Us / 1000.0;
+    case P99Role: return stats.p99Us / 1000.0;
+    case MaxRole: return stats.maxUs / 1000.0;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> CallStatsModel::roleNames() const
+{
+    return {
+        {MethodRole, "method"},
+        {CallsRole, "calls"},
+        {ErrorsRole, "errors"},
+        {P50Role, "p50"},
+        {P99Role, "p99"},
+        {MaxRole, "max"},
+    };
+}
+
+int CallStatsModel::totalCalls() const
+{
+    quint64 total = 0;
+    for (const CallTrace::MethodStats &stats : m_stats) total += stats.calls;
+    return int(total);
+}
+
+int CallStatsModel::totalErrors() const
+{
+    quint64 total = 0;
+    for (const CallTrace::MethodStats &stats : m_stats) total += stats.errors;
+    return int(total);
+}
+
+void CallStatsModel::update()
+{
+    QList<CallTrace::MethodStats> fresh = m_trace->methodStats();
+    const int known = m_stats.size();
+
+    // 1. Methods seen for the first time go at the end
+    if (fresh.size() > known) {
+        beginInsertRows(QModelIndex(), known, fresh.size() - 1);
+        m_stats = std::move(fresh);
+        endInsertRows();
+    } else {
+        m_stats = std::move(fresh);
+    }
+
+    // 2. Everything already shown has new numbers
+    if (known > 0) emit dataChanged(index(0), index(known - 1), {CallsRole, ErrorsRole, P50Role, P99Role, MaxRole});
+
+    emit updated();
+}
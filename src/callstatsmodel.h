@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+
+#include "calltrace.h"
+
+// Per-method latency of firewalld calls, one row per method; update() polls the trace
+class CallStatsModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int totalCalls READ totalCalls NOTIFY updated)
+    Q_PROPERTY(int totalErrors READ totalErrors NOTIFY updated)
+
+public:
+    enum Roles {
+        MethodRole = Qt::UserRole + 1,
+        CallsRole,
+        ErrorsRole,
+        P50Role, // milliseconds, as are the two below
+        P99Role,
+        MaxRole,
+    };
+    Q_ENUM(Roles)
+
+    explicit CallStatsModel(const CallTrace *trace, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int totalCalls() const;
+    int totalErrors() const;
+
+    Q_INVOKABLE void update();
+
+signals:
+    void updated();
+
+private:
+    const CallTrace *m_trace;
+    QList<CallTrace::MethodStats> m_stats;
+};
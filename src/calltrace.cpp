@@ -0,0 +1,313 @@
+#include "calltrace.h"
+
+#include <QCoreApplication>
+#include <QDBusArgument>
+#include <QDBusObjectPath>
+#include <QDBusSignature>
+#include <QDBusVariant>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QVariant>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// "getSettings2" for the main interface, "zone.addPort", "config.zone.update2",
+// "Properties.Get" for the rest
+static QString methodName(const QString &interface, const QString &method)
+{
+    static const QString firewalld = QStringLiteral("org.fedoraproject.FirewallD1");
+
+    const QString scope = interface.startsWith(firewalld) ? interface.mid(firewalld.size() + 1)
+                                                          : interface.section(QLatin1Char('.'), -1);
+    return scope.isEmpty() ? method : scope + QLatin1Char('.') + method;
+}
+
+template <std::size_t N>
+static void copyTruncated(char (&out)[N], const QString &text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    const std::size_t length = std::min<std::size_t>(utf8.size(), N - 1);
+    std::memcpy(out, utf8.constData(), length);
+    out[length] = '\0';
+}
+
+// === SETUP ===
+
+CallTrace::CallTrace()
+{
+    copyTruncated(m_histograms[MaxMethods].method, QStringLiteral("other"));
+}
+
+qint64 CallTrace::now()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+// === REPLY SIZE ===
+// Walks a copy, so the caller's own demarshalling still starts at the beginning
+
+static qint64 variantSize(const QVariant &value);
+
+static qint64 argumentSize(const QDBusArgument &arg)
+{
+    qint64 size = 0;
+    while (!arg.atEnd()) {
+        switch (arg.currentType()) {
+        case QDBusArgument::BasicType:
+        case QDBusArgument::VariantType:
+            size += variantSize(arg.asVariant());
+            break;
+        case QDBusArgument::StructureType:
+            arg.beginStructure();
+            size += argumentSize(arg);
+            arg.endStructure();
+            break;
+        case QDBusArgument::ArrayType:
+            arg.beginArray();
+            size += 4 + argumentSize(arg);
+            arg.endArray();
+            break;
+        case QDBusArgument::MapType:
+            arg.beginMap();
+            size += 4 + argumentSize(arg);
+            arg.endMap();
+            break;
+        case QDBusArgument::MapEntryType:
+            arg.beginMapEntry();
+            size += argumentSize(arg);
+            arg.endMapEntry();
+            break;
+        default:
+            return size;
+        }
+    }
+    return size;
+}
+
+static qint64 variantSize(const QVariant &value)
+{
+    const int type = value.metaType().id();
+
+    // Strings go out as a length, the UTF-8 bytes and a NUL; firewalld's are ASCII
+    if (type == QMetaType::QString) return 5 + value.toString().size();
+    if (type == QMetaType::QStringList) {
+        qint64 size = 4;
+        for (const QString &s : value.toStringList()) size += 5 + s.size();
+        return size;
+    }
+    if (type == QMetaType::QByteArray) return 4 + value.toByteArray().size();
+    if (type == qMetaTypeId<QDBusObjectPath>()) return 5 + value.value<QDBusObjectPath>().path().size();
+    if (type == qMetaTypeId<QDBusSignature>()) return 2 + value.value<QDBusSignature>().signature().size();
+    if (type == qMetaTypeId<QDBusVariant>()) return 4 + variantSize(value.value<QDBusVariant>().variant());
+    if (type == qMetaTypeId<QDBusArgument>()) return argumentSize(value.value<QDBusArgument>());
+
+    return value.metaType().sizeOf();
+}
+
+qint64 CallTrace::replySize(const QList<QVariant> &arguments)
+{
+    qint64 size = 0;
+    for (const QVariant &argument : arguments) size += variantSize(argument);
+    return size;
+}
+
+// === WRITER (worker thread) ===
+
+void CallTrace::record(const QString &interface, const QString &method, const QString &path,
+                       qint64 startNs, qint64 durationNs, qint64 replyBytes, const QString &error)
+{
+    const QString name = methodName(interface, method);
+
+    // 1. Ring: odd sequence while the slot is being rewritten
+    const quint64 index = m_written.load(std::memory_order_relaxed);
+    Slot &slot = m_slots[index % Capacity];
+    const quint64 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    copyTruncated(slot.record.method, name);
+    copyTruncated(slot.record.path, path);
+    copyTruncated(slot.record.error, error);
+    slot.record.startNs = startNs;
+    slot.record.durationNs = durationNs;
+    slot.record.replyBytes = replyBytes;
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    m_written.store(index + 1, std::memory_order_release);
+
+    // 2. Histogram; only this thread writes, readers just see slightly old counts
+    Histogram &histogram = histogramFor(name);
+    const qint64 us = durationNs / 1000;
+    histogram.buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    if (!error.isEmpty()) histogram.errors.fetch_add(1, std::memory_order_relaxed);
+    if (us > histogram.maxUs.load(std::memory_order_relaxed)) histogram.maxUs.store(us, std::memory_order_relaxed);
+}
+
+CallTrace::Histogram &CallTrace::histogramFor(const QString &name)
+{
+    auto known = m_methodIndex.constFind(name);
+    if (known != m_methodIndex.constEnd()) return m_histograms[*known];
+
+    const int count = m_methodCount.load(std::memory_order_relaxed);
+    if (count == MaxMethods) return m_histograms[MaxMethods];
+
+    // The name is in place before the count that publishes it
+    copyTruncated(m_histograms[count].method, name);
+    m_methodIndex.insert(name, count);
+    m_methodCount.store(count + 1, std::memory_order_release);
+    return m_histograms[count];
+}
+
+// === BUCKETS ===
+// Exact below 2 * HalfBucket µs, then HalfBucket steps per power of two
+
+int CallTrace::bucketFor(qint64 us)
+{
+    const quint64 value = quint64(std::clamp<qint64>(us, 0, (qint64(1) << 32) - 1));
+    const int msb = 63 - qCountLeadingZeroBits(value | quint64(2 * HalfBucket - 1));
+    const int shift = msb - (SubBucketBits - 1);
+    return shift * HalfBucket + int(value >> shift);
+}
+
+qint64 CallTrace::bucketUpperBound(int bucket)
+{
+    if (bucket < 2 * HalfBucket) return bucket;
+    const int shift = bucket / HalfBucket - 1;
+    const qint64 step = bucket - shift * HalfBucket;
+    return ((step + 1) << shift) - 1;
+}
+
+qint64 CallTrace::percentile(const Counts &counts, quint64 total, double fraction)
+{
+    if (total == 0) return 0;
+
+    const quint64 rank = std::max<quint64>(1, quint64(std::ceil(fraction * double(total))));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) return bucketUpperBound(bucket);
+    }
+    return bucketUpperBound(BucketCount - 1);
+}
+
+// === READERS (any thread) ===
+
+QList<CallTrace::Call> CallTrace::calls() const
+{
+    const quint64 written = m_written.load(std::memory_order_acquire);
+    const quint64 first = written > Capacity ? written - Capacity : 0;
+
+    QList<Call> out;
+    out.reserve(int(written - first));
+
+    for (quint64 index = first; index < written; ++index) {
+        const Slot &slot = m_slots[index % Capacity];
+
+        // The n-th write to a slot leaves its sequence at 2n
+        const quint64 expected = 2 * (index / Capacity + 1);
+        if (slot.sequence.load(std::memory_order_acquire) != expected) continue;
+
+        Record copy;
+        std::memcpy(&copy, &slot.record, sizeof copy);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) continue;
+
+        Call call;
+        call.method = QString::fromUtf8(copy.method);
+        call.path = QString::fromUtf8(copy.path);
+        call.error = QString::fromUtf8(copy.error);
+        call.startNs = copy.startNs;
+        call.durationNs = copy.durationNs;
+        call.replyBytes = copy.replyBytes;
+        out.append(call);
+    }
+
+    return out;
+}
+
+QList<CallTrace::MethodStats> CallTrace::methodStats() const
+{
+    const int count = m_methodCount.load(std::memory_order_acquire);
+
+    QList<MethodStats> out;
+    out.reserve(count + 1);
+
+    for (int i = 0; i <= MaxMethods; ++i) {
+        if (i == count && i < MaxMethods) i = MaxMethods; // skip unused slots, keep "other"
+
+        const Histogram &histogram = m_histograms[i];
+        Counts counts;
+        quint64 total = 0;
+        for (int bucket = 0; bucket < BucketCount; ++bucket) {
+            counts[bucket] = histogram.buckets[bucket].load(std::memory_order_relaxed);
+            total += counts[bucket];
+        }
+        if (i == MaxMethods && total == 0) break;
+
+        MethodStats stats;
+        stats.method = QString::fromUtf8(histogram.method);
+        stats.calls = total;
+        stats.errors = histogram.errors.load(std::memory_order_relaxed);
+        stats.p50Us = percentile(counts, total, 0.50);
+        stats.p99Us = percentile(counts, total, 0.99);
+        stats.maxUs = histogram.maxUs.load(std::memory_order_relaxed);
+        out.append(stats);
+    }
+
+    return out;
+}
+
+// === EXPORT ===
+
+QByteArray CallTrace::toChromeTrace() const
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    // Calls overlap, so each is an async begin/end pair rather than a complete event
+    QJsonArray events;
+    quint64 id = 0;
+    for (const Call &call : calls()) {
+        QJsonObject args{{"path", call.path}, {"replyBytes", call.replyBytes}};
+        if (!call.error.isEmpty()) args.insert("error", call.error);
+
+        const QJsonObject common{
+            {"name", call.method},
+            {"cat", "dbus"},
+            {"id", QString::number(++id)},
+            {"pid", pid},
+            {"tid", 1},
+        };
+
+        QJsonObject begin = common;
+        begin.insert("ph", "b");
+        begin.insert("ts", double(call.startNs) / 1000.0);
+        begin.insert("args", args);
+        events.append(begin);
+
+        QJsonObject end = common;
+        end.insert("ph", "e");
+        end.insert("ts", double(call.startNs + call.durationNs) / 1000.0);
+        events.append(end);
+    }
+
+    return QJsonDocument(QJsonObject{{"traceEvents", events}, {"displayTimeUnit", "ms"}}).toJson(QJsonDocument::Compact);
+}
+
+bool CallTrace::writeChromeTrace(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(toChromeTrace());
+    return file.commit();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+class QVariant;
+
+// Flight recorder for firewalld calls: the last Capacity calls in a ring, plus a
+// log-linear latency histogram per method (within ~3%). The worker writes, anyone
+// reads, nothing locks; a ring slot torn mid-copy is dropped.
+class CallTrace
+{
+public:
+    static constexpr std::size_t Capacity = 2048;
+    static constexpr int MaxMethods = 64; // later ones are counted as "other"
+
+    struct Call {
+        QString method; // "getSettings2", "zone.addPort", "config.zone.update2"
+        QString path;
+        QString error;  // D-Bus error name, empty on success
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        qint64 replyBytes = 0;
+    };
+
+    struct MethodStats {
+        QString method;
+        quint64 calls = 0;
+        quint64 errors = 0;
+        qint64 p50Us = 0;
+        qint64 p99Us = 0;
+        qint64 maxUs = 0;
+    };
+
+    CallTrace();
+
+    // Monotonic, shared by every trace in the process
+    static qint64 now();
+
+    // Approximate wire size of a reply's arguments, alignment padding aside
+    static qint64 replySize(const QList<QVariant> &arguments);
+
+    // Worker thread only
+    void record(const QString &interface, const QString &method, const QString &path,
+                qint64 startNs, qint64 durationNs, qint64 replyBytes, const QString &error);
+
+    // Any thread. Oldest first; records overwritten while being read are skipped.
+    QList<Call> calls() const;
+    // In first-seen order, so rows never move
+    QList<MethodStats> methodStats() const;
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto), one async event per call
+    QByteArray toChromeTrace() const;
+    bool writeChromeTrace(const QString &fileName) const;
+
+private:
+    static constexpr int SubBucketBits = 6;
+    static constexpr int HalfBucket = 1 << (SubBucketBits - 1);
+    static constexpr int BucketCount = (32 - SubBucketBits + 1) * HalfBucket + HalfBucket; // up to 2^32 µs
+
+    // Fixed-size and trivially copyable, so a slot can be copied while racing the writer
+    struct Record {
+        char method[48];
+        char path[64];
+        char error[64];
+        qint64 startNs;
+        qint64 durationNs;
+        qint64 replyBytes;
+    };
+
+    struct Slot {
+        std::atomic<quint64> sequence{0}; // odd while being written
+        Record record;
+    };
+
+    struct Histogram {
+        char method[48] = {};
+        std::atomic<quint64> errors{0};
+        std::atomic<qint64> maxUs{0};
+        std::array<std::atomic<quint32>, BucketCount> buckets{};
+    };
+
+    using Counts = std::array<quint32, BucketCount>;
+
+    static int bucketFor(qint64 us);
+    static qint64 bucketUpperBound(int bucket);
+    static qint64 percentile(const Counts &counts, quint64 total, double fraction);
+
+    Histogram &histogramFor(const QString &name);
+
+    std::array<Slot, Capacity> m_slots;
+    std::atomic<quint64> m_written{0};
+
+    std::array<Histogram, MaxMethods + 1> m_histograms; // the last one is "other"
+    std::atomic<int> m_methodCount{0};
+    QHash<QString, int> m_methodIndex; // worker thread only
+};
@@ -0,0 +1,310 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <cstdio>
+
+#include "configwriter.h"
+#include "firewallconnection.h"
+#include "firewalld_interface.h"
+#include "firewalld_zone_interface.h"
+#include "firewalld_config_zone_interface.h"
+#include "policy.h"
+#include "startuptiming.h"
+
+// Headless front end; every command prints JSON and exits non-zero on failure
+
+static bool s_pretty = false;
+
+static void print(const QJsonObject &object)
+{
+    const QByteArray json = QJsonDocument(object).toJson(s_pretty ? QJsonDocument::Indented : QJsonDocument::Compact);
+    std::fwrite(json.constData(), 1, json.size(), stdout);
+    if (!s_pretty) std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+static void printResult(const QJsonObject &object)
+{
+    print(object);
+    StartupTiming::mark("first result");
+}
+
+// Queued, so it also ends a loop that exec() has not started yet
+static int fail(const QString &error)
+{
+    printResult(QJsonObject{{"ok", false}, {"error", error}});
+    QMetaObject::invokeMethod(QCoreApplication::instance(), []() { QCoreApplication::exit(1); }, Qt::QueuedConnection);
+    return 1;
+}
+
+static FirewallConnection *openBus(const QString &address)
+{
+    return address.isEmpty() ? new FirewallConnection(QDBusConnection::SystemBus) : new FirewallConnection(address);
+}
+
+// === LIST ===
+
+static void list(FirewallConnection *bus, const QString &zone)
+{
+    if (!zone.isEmpty()) {
+        bus->readZone(zone, [zone](bool found, const ZoneSettings &settings) {
+            if (!found) {
+                fail("No such zone: " + zone);
+                return;
+            }
+            printResult(QJsonObject{{"zone", zone}, {"settings", settings.toJson()}});
+            QCoreApplication::exit(0);
+        });
+        return;
+    }
+
+    // Same shape as a saved policy, so the output feeds straight back into apply-policy
+    bus->readState([](const FirewallStatePtr &state) {
+        if (!state || !state->complete) {
+            fail("Could not read the firewall state");
+            return;
+        }
+        const QByteArray json = Policy::toJson(state->defaultZone, state->logDenied, state->panic, state->zones);
+        printResult(QJsonDocument::fromJson(json).object());
+        QCoreApplication::exit(0);
+    });
+}
+
+// === ADD / REMOVE ===
+
+// "port=80:proto=tcp:toport=8080:toaddr=10.0.0.2", as firewall-cmd takes it
+static bool parseForward(const QString &value, ForwardPort &out)
+{
+    for (const QString &field : value.split(':', Qt::SkipEmptyParts)) {
+        const QString key = field.section('=', 0, 0);
+        const QString val = field.section('=', 1);
+        if (key == "port") out.port = val;
+        else if (key == "proto") out.protocol = val;
+        else if (key == "toport") out.toPort = val;
+        else if (key == "toaddr") out.toAddr = val;
+        else return false;
+    }
+    return !out.port.isEmpty() && !out.protocol.isEmpty() && (!out.toPort.isEmpty() || !out.toAddr.isEmpty());
+}
+
+// The runtime zone and the permanent config in one go, as the window does it
+static bool editCalls(bool add, const QString &kind, const QString &value, const QString &zone,
+                      QList<DBusCall> &calls, QString &error)
+{
+    if (kind == "service") {
+        calls = add ? QList<DBusCall>{DBusCall::runtimeZone("addService", [=](auto *z) { return z->addService(zone, value, 0); }),
+                                      DBusCall::configZone(zone, "addService", [=](auto *z) { return z->addService(value); })}
+                    : QList<DBusCall>{DBusCall::runtimeZone("removeService", [=](auto *z) { return z->removeService(zone, value); }),
+                                      DBusCall::configZone(zone, "removeService", [=](auto *z) { return z->removeService(value); })};
+        return true;
+    }
+
+    if (kind == "source") {
+        calls = add ? QList<DBusCall>{DBusCall::runtimeZone("addSource", [=](auto *z) { return z->addSource(zone, value); }),
+                                      DBusCall::configZone(zone, "addSource", [=](auto *z) { return z->addSource(value); })}
+                    : QList<DBusCall>{DBusCall::runtimeZone("removeSource", [=](auto *z) { return z->removeSource(zone, value); }),
+                                      DBusCall::configZone(zone, "removeSource", [=](auto *z) { return z->removeSource(value); })};
+        return true;
+    }
+
+    if (kind == "port") {
+        const QString port = value.section('/', 0, 0);
+        const QString protocol = value.section('/', 1);
+        if (port.isEmpty() || protocol.isEmpty()) {
+            error = "Expected <port>/<protocol>, got: " + value;
+            return false;
+        }
+        calls = add ? QList<DBusCall>{DBusCall::runtimeZone("addPort", [=](auto *z) { return z->addPort(zone, port, protocol, 0); }),
+                                      DBusCall::configZone(zone, "addPort", [=](auto *z) { return z->addPort(port, protocol); })}
+                    : QList<DBusCall>{DBusCall::runtimeZone("removePort", [=](auto *z) { return z->removePort(zone, port, protocol); }),
+                                      DBusCall::configZone(zone, "removePort", [=](auto *z) { return z->removePort(port, protocol); })};
+        return true;
+    }
+
+    if (kind == "forward") {
+        ForwardPort forward;
+        if (!parseForward(value, forward)) {
+            error = "Expected port=<port>:proto=<protocol>:toport=<port>[:toaddr=<address>], got: " + value;
+            return false;
+        }
+        calls = add ? QList<DBusCall>{DBusCall::runtimeZone("addForwardPort", [=](auto *z) {
+                                          return z->addForwardPort(zone, forward.port, forward.protocol, forward.toPort, forward.toAddr, 0);
+                                      }),
+                                      DBusCall::configZone(zone, "addForwardPort", [=](auto *z) {
+                                          return z->addForwardPort(forward.port, forward.protocol, forward.toPort, forward.toAddr);
+                                      })}
+                    : QList<DBusCall>{DBusCall::runtimeZone("removeForwardPort", [=](auto *z) {
+                                          return z->removeForwardPort(zone, forward.port, forward.protocol, forward.toPort, forward.toAddr);
+                                      }),
+                                      DBusCall::configZone(zone, "removeForwardPort", [=](auto *z) {
+                                          return z->removeForwardPort(forward.port, forward.protocol, forward.toPort, forward.toAddr);
+                                      })};
+        return true;
+    }
+
+    error = "Unknown rule kind: " + kind + " (expected service, port, source or forward)";
+    return false;
+}
+
+static void edit(FirewallConnection *bus, bool add, const QString &kind, const QString &value, const QString &zone)
+{
+    QList<DBusCall> calls;
+    QString error;
+    if (!editCalls(add, kind, value, zone, calls, error)) {
+        fail(error);
+        return;
+    }
+
+    const QJsonObject base{{"action", add ? "add" : "remove"}, {"kind", kind}, {"value", value}, {"zone", zone}};
+    auto remaining = QSharedPointer<int>::create(calls.size());
+    auto errors = QSharedPointer<QJsonArray>::create();
+
+    for (const DBusCall &call : calls) {
+        bus->call(call, [base, remaining, errors](const DBusResult &reply) {
+            if (reply.isError() && !isBenignFirewallError(reply.error)) errors->append(reply.error.message());
+            if (--*remaining > 0) return;
+
+            QJsonObject out = base;
+            out.insert("ok", errors->isEmpty());
+            out.insert("errors", *errors);
+            printResult(out);
+            QCoreApplication::exit(errors->isEmpty() ? 0 : 1);
+        });
+    }
+}
+
+static void editInZone(FirewallConnection *bus, bool add, const QString &kind, const QString &value, const QString &zone)
+{
+    if (!zone.isEmpty()) {
+        edit(bus, add, kind, value, zone);
+        return;
+    }
+
+    const DBusCall defaultZone = DBusCall::main("getDefaultZone", [](auto *fw) { return fw->getDefaultZone(); });
+    bus->call(defaultZone, [bus, add, kind, value](const DBusResult &reply) {
+        if (reply.isError()) {
+            fail("Could not read the default zone: " + reply.error.message());
+            return;
+        }
+        edit(bus, add, kind, value, reply.arguments.value(0).toString());
+    });
+}
+
+// === APPLY-POLICY ===
+
+static void applyPolicy(FirewallConnection *bus, const QString &fileName)
+{
+    QFile file(fileName);
+    const bool opened = fileName == "-" ? file.open(stdin, QIODevice::ReadOnly) : file.open(QIODevice::ReadOnly);
+    if (!opened) {
+        fail("Could not open " + fileName + ": " + file.errorString());
+        return;
+    }
+    Policy policy;
+    QString error;
+    if (!Policy::fromJson(file.readAll(), policy, error)) {
+        fail("Invalid policy: " + error);
+        return;
+    }
+
+    // Written the way the window writes it, with nothing else of the backend started
+    auto *writer = new ConfigWriter(bus, bus);
+    writer->applyPolicy(policy, [](const QVariantMap &result) {
+        printResult(QJsonObject::fromVariantMap(result));
+        QCoreApplication::exit(result.value("ok").toBool() ? 0 : 1);
+    });
+}
+
+// === WATCH ===
+
+static void event(const QString &type, QJsonObject fields = {})
+{
+    fields.insert("event", type);
+    fields.insert("time", QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs));
+    print(fields);
+}
+
+static void watch(FirewallConnection *bus)
+{
+    QObject::connect(bus, &FirewallConnection::zonesChanged, bus, []() { event("zonesChanged"); });
+    QObject::connect(bus, &FirewallConnection::zoneUpdated, bus, [](const QString &zone) {
+        event("zoneUpdated", {{"zone", zone}});
+    });
+    QObject::connect(bus, &FirewallConnection::runtimeChanged, bus, [](const QString &zone) {
+        event("runtimeChanged", {{"zone", zone}});
+    });
+    QObject::connect(bus, &FirewallConnection::defaultZoneChanged, bus, [](const QString &zone) {
+        event("defaultZoneChanged", {{"zone", zone}});
+    });
+    QObject::connect(bus, &FirewallConnection::panicChanged, bus, [](bool enabled) {
+        event("panicChanged", {{"enabled", enabled}});
+    });
+    QObject::connect(bus, &FirewallConnection::logDeniedChanged, bus, [](const QString &value) {
+        event("logDeniedChanged", {{"value", value}});
+    });
+
+    // The first line says whether anything will follow
+    QObject::connect(bus, &FirewallConnection::opened, bus, [](bool connected) {
+        if (!connected) {
+            fail("Could not reach firewalld");
+            return;
+        }
+        event("watching");
+        StartupTiming::mark("first result");
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    StartupTiming::start();
+
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("Nitrux");
+    app.setApplicationName("Cinderward");
+    StartupTiming::mark("application created");
+
+    // 1. COMMAND LINE
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Scriptable firewalld front end; every command prints JSON.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "list | add <kind> <value> | remove <kind> <value> | apply-policy <file|-> | watch");
+    parser.addPositionalArgument("kind", "service, port (80/tcp), source or forward (port=80:proto=tcp:toport=8080[:toaddr=...])", "[kind]");
+    parser.addPositionalArgument("value", "The rule to add or remove", "[value]");
+
+    const QCommandLineOption zoneOption("zone", "Zone to list or edit; defaults to all zones (list) or the default zone.", "zone");
+    const QCommandLineOption prettyOption("pretty", "Indent the JSON.");
+    const QCommandLineOption addressOption("bus-address", "Talk to firewalld on this D-Bus address instead of the system bus.", "address");
+    parser.addOptions({zoneOption, prettyOption, addressOption});
+    parser.process(app);
+
+    s_pretty = parser.isSet(prettyOption);
+    const QStringList args = parser.positionalArguments();
+    const QString command = args.value(0);
+    const QString zone = parser.value(zoneOption);
+
+    // 2. DISPATCH
+    // Everything below answers from the event loop, which exec() starts
+    FirewallConnection *bus = openBus(parser.value(addressOption));
+    bus->setParent(&app);
+
+    if (command == "list" && args.size() == 1) {
+        list(bus, zone);
+    } else if ((command == "add" || command == "remove") && args.size() == 3) {
+        editInZone(bus, command == "add", args.at(1), args.at(2), zone);
+    } else if (command == "apply-policy" && args.size() == 2) {
+        applyPolicy(bus, args.at(1));
+    } else if (command == "watch" && args.size() == 1) {
+        watch(bus);
+    } else {
+        QTextStream(stderr) << parser.helpText();
+        return fail(command.isEmpty() ? QStringLiteral("No command given") : "Unknown command or wrong arguments: " + args.join(' '));
+    }
+
+    return app.exec();
+}
@@ -0,0 +1,198 @@
+#include "configwriter.h"
+#include "firewallconnection.h"
+#include "firewalld_interface.h"
+#include "firewalld_config_zone_interface.h"
+#include "policy.h"
+
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+
+struct ConfigWriter::Commit {
+    int staged = 0;
+    int pendingZones = 0;
+    QStringList changedZones;
+    QVariantList errors;
+    Done done;
+};
+
+ConfigWriter::ConfigWriter(FirewallConnection *bus, QObject *parent)
+    : QObject(parent)
+    , m_bus(bus)
+{
+}
+
+QVariantMap ConfigWriter::editError(const Edit &edit, const QString &message)
+{
+    return QVariantMap{
+        {"zone", edit.zone},
+        {"action", edit.action},
+        {"item", edit.item},
+        {"message", message},
+    };
+}
+
+// === COMMIT ===
+
+void ConfigWriter::commit(const QList<Edit> &edits, const QVariantList &rejected, const Done &done,
+                          const QHash<QString, ZoneSettings> &bases)
+{
+    auto commit = QSharedPointer<Commit>::create();
+    commit->staged = edits.size() + rejected.size();
+    commit->errors = rejected;
+    commit->done = done;
+
+    // Group by zone, keeping the order the edits were made in
+    QStringList zones;
+    QHash<QString, QList<Edit>> byZone;
+    for (const Edit &edit : edits) {
+        if (!byZone.contains(edit.zone)) zones.append(edit.zone);
+        byZone[edit.zone].append(edit);
+    }
+
+    if (zones.isEmpty()) {
+        finish(commit, false);
+        return;
+    }
+
+    commit->pendingZones = zones.size();
+    for (const QString &zone : std::as_const(zones)) {
+        const auto base = bases.constFind(zone);
+        if (base != bases.constEnd()) sendZone(commit, zone, byZone.value(zone), *base);
+        else commitZone(commit, zone, byZone.value(zone));
+    }
+}
+
+void ConfigWriter::commitZone(const QSharedPointer<Commit> &commit, const QString &zone, const QList<Edit> &edits)
+{
+    // update2 replaces whole lists, so start from a fresh permanent read
+    m_bus->readZone(zone, [this, commit, zone, edits](bool found, const ZoneSettings &base) {
+        if (!found) {
+            for (const Edit &edit : edits) commit->errors.append(editError(edit, "Could not find path for zone: " + zone));
+            finishZone(commit);
+            return;
+        }
+        sendZone(commit, zone, edits, base);
+    });
+}
+
+void ConfigWriter::sendZone(const QSharedPointer<Commit> &commit, const QString &zone, const QList<Edit> &edits, const ZoneSettings &base)
+{
+    // Replay the edits and send only the keys whose net value changed
+    ZoneSettings desired = base;
+    for (const Edit &edit : edits) edit.apply(desired);
+
+    const QVariantMap delta = desired.deltaFrom(base);
+    if (delta.isEmpty()) {
+        finishZone(commit);
+        return;
+    }
+
+    const auto update = [delta](auto *z) { return z->update2(delta); };
+    m_bus->call(DBusCall::configZone(zone, "update2", update), [this, commit, zone, edits](const DBusResult &reply) {
+        if (reply.isError()) {
+            for (const Edit &edit : edits) commit->errors.append(editError(edit, reply.error.message()));
+        } else {
+            commit->changedZones.append(zone);
+        }
+        finishZone(commit);
+    });
+}
+
+void ConfigWriter::finishZone(const QSharedPointer<Commit> &commit)
+{
+    if (--commit->pendingZones > 0) return;
+
+    if (commit->changedZones.isEmpty()) {
+        finish(commit, false);
+        return;
+    }
+
+    // update2 only touches the permanent config; one reload makes all of it live
+    m_bus->call(DBusCall::main("reload", [](auto *fw) { return fw->reload(); }), [this, commit](const DBusResult &reply) {
+        if (reply.isError()) {
+            commit->errors.append(QVariantMap{{"action", "reload"}, {"message", reply.error.message()}});
+        }
+        finish(commit, !reply.isError());
+    });
+}
+
+void ConfigWriter::finish(const QSharedPointer<Commit> &commit, bool reloaded)
+{
+    QVariantMap result;
+    result.insert("ok", commit->errors.isEmpty());
+    result.insert("staged", commit->staged);
+    result.insert("zones", commit->changedZones);
+    result.insert("reloaded", reloaded);
+    result.insert("errors", commit->errors);
+    if (commit->done) commit->done(result);
+}
+
+// === POLICY FILES ===
+
+void ConfigWriter::applyPolicy(const Policy &policy, const Done &done)
+{
+    m_bus->readState([this, policy, done](const FirewallStatePtr &state) {
+        if (!state || !state->complete) {
+            done(QVariantMap{{"ok", false}, {"errors", QVariantList{QVariantMap{{"message", "Could not read the firewall state"}}}}});
+            return;
+        }
+
+        // 1. One edit per zone, diffed against the state just read: a policy already in force sends nothing
+        QList<Edit> edits;
+        QVariantList rejected;
+        for (auto it = policy.zones.constBegin(); it != policy.zones.constEnd(); ++it) {
+            const ZonePolicy zonePolicy = it.value();
+            const Edit edit{it.key(), "applyPolicy", it.key(), [zonePolicy](ZoneSettings &z) { zonePolicy.applyTo(z); }};
+            if (!state->zones.contains(it.key())) rejected.append(editError(edit, "No such zone: " + it.key()));
+            else edits.append(edit);
+        }
+
+        // 2. Global switches are not zone settings; each one that moved is a single call
+        QList<QPair<QString, DBusCall>> globals;
+        if (policy.logDenied && *policy.logDenied != state->logDenied) {
+            const QString value = *policy.logDenied;
+            globals.append({"logDenied", DBusCall::main("setLogDenied", [value](auto *fw) { return fw->setLogDenied(value); })});
+        }
+        if (policy.defaultZone && *policy.defaultZone != state->defaultZone) {
+            if (!state->zones.contains(*policy.defaultZone)) {
+                rejected.append(QVariantMap{{"action", "defaultZone"}, {"item", *policy.defaultZone},
+                                            {"message", "No such zone: " + *policy.defaultZone}});
+            } else {
+                const QString zone = *policy.defaultZone;
+                globals.append({"defaultZone", DBusCall::main("setDefaultZone", [zone](auto *fw) { return fw->setDefaultZone(zone); })});
+            }
+        }
+        if (policy.panic && *policy.panic != state->panic) {
+            globals.append({"panic", *policy.panic ? DBusCall::main("enablePanicMode", [](auto *fw) { return fw->enablePanicMode(); })
+                                                   : DBusCall::main("disablePanicMode", [](auto *fw) { return fw->disablePanicMode(); })});
+        }
+
+        // 3. Globals go after the reload, so it can't undo them
+        commit(edits, rejected, [this, globals, done](const QVariantMap &batch) {
+            auto result = QSharedPointer<QVariantMap>::create(batch);
+            result->remove("staged");
+            result->insert("globals", QStringList());
+            if (globals.isEmpty()) {
+                done(*result);
+                return;
+            }
+
+            auto remaining = QSharedPointer<int>::create(globals.size());
+            for (const auto &global : globals) {
+                m_bus->call(global.second, [result, remaining, done, name = global.first](const DBusResult &reply) {
+                    if (reply.isError() && !isBenignFirewallError(reply.error)) {
+                        QVariantList errors = result->value("errors").toList();
+                        errors.append(QVariantMap{{"action", name}, {"message", reply.error.message()}});
+                        result->insert("errors", errors);
+                        result->insert("ok", false);
+                    } else {
+                        result->insert("globals", result->value("globals").toStringList() << name);
+                    }
+
+                    if (--*remaining == 0) done(*result);
+                });
+            }
+        }, state->zones);
+    });
+}
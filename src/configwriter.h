@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <functional>
+
+#include "zonesettings.h"
+
+class FirewallConnection;
+struct Policy;
+
+// Batches and policy files: one update2 per touched zone, from a fresh read, then one reload
+class ConfigWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    // One edit, replayed on a copy of the zone's settings at commit time
+    struct Edit {
+        QString zone;
+        QString action;
+        QString item;
+        std::function<void(ZoneSettings &)> apply;
+    };
+
+    // {ok, staged, zones, reloaded, errors: [{zone, action, item, message}]};
+    // applyPolicy() drops staged and adds globals
+    using Done = std::function<void(const QVariantMap &result)>;
+
+    explicit ConfigWriter(FirewallConnection *bus, QObject *parent = nullptr);
+
+    // `rejected` are edits already turned down, reported along with the rest.
+    // Zones in `bases` were just read and are diffed against that copy, not re-read.
+    void commit(const QList<Edit> &edits, const QVariantList &rejected, const Done &done,
+                const QHash<QString, ZoneSettings> &bases = {});
+
+    // Commits the zones that differ, then the global switches that moved
+    void applyPolicy(const Policy &policy, const Done &done);
+
+    static QVariantMap editError(const Edit &edit, const QString &message);
+
+private:
+    struct Commit;
+
+    void commitZone(const QSharedPointer<Commit> &commit, const QString &zone, const QList<Edit> &edits);
+    void sendZone(const QSharedPointer<Commit> &commit, const QString &zone, const QList<Edit> &edits, const ZoneSettings &base);
+    void finishZone(const QSharedPointer<Commit> &commit);
+    void finish(const QSharedPointer<Commit> &commit, bool reloaded);
+
+    FirewallConnection *m_bus;
+};
@@ -0,0 +1,288 @@
+#include "deniedlog.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QMutexLocker>
+#include <QScopeGuard>
+#include <QThread>
+
+#include <cerrno>
+#include <memory>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// How long the reader waits for more when the source has nothing new
+const int IDLE_WAIT_MS = 100;
+
+// === TOKENIZER ===
+// In place; nothing is copied until the prefix matches
+
+namespace {
+
+struct Token {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+
+    qsizetype size() const { return end - begin; }
+    bool operator==(const char *text) const
+    {
+        const qsizetype length = qsizetype(std::strlen(text));
+        return size() == length && std::memcmp(begin, text, length) == 0;
+    }
+};
+
+}
+
+template <std::size_t N>
+static void copyField(char (&out)[N], const Token &token)
+{
+    const std::size_t length = std::min<std::size_t>(std::size_t(token.size()), N - 1);
+    std::memcpy(out, token.begin, length);
+    out[length] = '\0';
+}
+
+// "IN=" at the start of a word
+static const char *findField(const char *begin, const char *end)
+{
+    for (const char *p = begin; end - p >= 3; ) {
+        const char *hit = static_cast<const char *>(::memmem(p, end - p, "IN=", 3));
+        if (!hit) return nullptr;
+        if (hit == begin || hit[-1] == ' ') return hit;
+        p = hit + 1;
+    }
+    return nullptr;
+}
+
+static quint16 parsePort(const Token &token)
+{
+    quint32 value = 0;
+    for (const char *p = token.begin; p < token.end; ++p) {
+        if (*p < '0' || *p > '9' || value > 65535) return 0;
+        value = value * 10 + quint32(*p - '0');
+    }
+    return value > 65535 ? 0 : quint16(value);
+}
+
+// "filter_IN_public_REJECT", "filter_FWD_home_DROP", "IN_public_DROP" (iptables
+// backend) or "FINAL_REJECT"
+static bool parsePrefix(const Token &prefix, Token &chain, Token &zone, Token &action)
+{
+    if (prefix == "FINAL_REJECT") {
+        static const char finalChain[] = "FINAL";
+        static const char reject[] = "REJECT";
+        chain = {finalChain, finalChain + 5};
+        zone = {prefix.begin, prefix.begin};
+        action = {reject, reject + 6};
+        return true;
+    }
+
+    const char *p = prefix.begin;
+    if (prefix.size() > 7 && std::memcmp(p, "filter_", 7) == 0) p += 7;
+
+    const char *chainEnd = static_cast<const char *>(std::memchr(p, '_', prefix.end - p));
+    if (!chainEnd) return false;
+    chain = {p, chainEnd};
+    if (!(chain == "IN" || chain == "FWD" || chain == "FWDI" || chain == "FWDO")) return false;
+
+    const char *actionBegin = prefix.end;
+    while (actionBegin > chainEnd + 1 && actionBegin[-1] != '_') --actionBegin;
+    if (actionBegin <= chainEnd + 2) return false; // no zone between
+    action = {actionBegin, prefix.end};
+    if (!(action == "REJECT" || action == "DROP" || action == "DENY")) return false;
+
+    zone = {chainEnd + 1, actionBegin - 1};
+    return true;
+}
+
+bool DeniedPacket::parse(const char *begin, const char *end, DeniedPacket &out)
+{
+    // 1. Netfilter puts "IN=" right after the log prefix
+    const char *fields = findField(begin, end);
+    if (!fields) return false;
+
+    // 2. The prefix is the word before it (after ';' in /dev/kmsg, a space otherwise)
+    Token prefix{fields, fields};
+    while (prefix.end > begin && prefix.end[-1] == ' ') --prefix.end;
+    if (prefix.end > begin && prefix.end[-1] == ':') --prefix.end;
+    prefix.begin = prefix.end;
+    while (prefix.begin > begin && prefix.begin[-1] != ' ' && prefix.begin[-1] != ';') --prefix.begin;
+
+    Token chain, zone, action;
+    if (!parsePrefix(prefix, chain, zone, action)) return false;
+
+    // 3. One of ours; the oldest packet in the ring gives way from here
+    out = DeniedPacket();
+    copyField(out.chain, chain);
+    copyField(out.zone, zone);
+    copyField(out.action, action);
+
+    for (const char *p = fields; p < end; ) {
+        const char *wordEnd = static_cast<const char *>(std::memchr(p, ' ', end - p));
+        if (!wordEnd) wordEnd = end;
+
+        const char *equals = static_cast<const char *>(std::memchr(p, '=', wordEnd - p));
+        if (equals) {
+            const Token key{p, equals};
+            const Token value{equals + 1, wordEnd};
+            if (key == "IN") copyField(out.interface, value);
+            else if (key == "SRC") copyField(out.source, value);
+            else if (key == "DST") copyField(out.destination, value);
+            else if (key == "PROTO") copyField(out.protocol, value);
+            else if (key == "SPT") out.sourcePort = parsePort(value);
+            else if (key == "DPT") out.destinationPort = parsePort(value);
+        }
+        p = wordEnd + 1;
+    }
+
+    return true;
+}
+
+// === STORE ===
+
+// "22/tcp", or just "icmp" where there are no ports
+static int portKey(const DeniedPacket &packet, char (&out)[24])
+{
+    int length = 0;
+    if (packet.destinationPort > 0) {
+        char digits[5];
+        int count = 0;
+        for (quint16 port = packet.destinationPort; port > 0; port /= 10) digits[count++] = char('0' + port % 10);
+        while (count > 0) out[length++] = digits[--count];
+        out[length++] = '/';
+    }
+    for (const char *p = packet.protocol; *p && length < int(sizeof out); ++p)
+        out[length++] = char(*p >= 'A' && *p <= 'Z' ? *p - 'A' + 'a' : *p);
+    return length;
+}
+
+qsizetype DeniedLogStore::feed(const char *data, qsizetype size, qint64 timeMs)
+{
+    QMutexLocker lock(&m_mutex);
+
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end) {
+        const char *newline = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!newline) break;
+
+        ++m_lines;
+        DeniedPacket &packet = m_ring[m_written % Capacity];
+        if (DeniedPacket::parse(p, newline, packet)) {
+            packet.timeMs = timeMs;
+            ++m_written;
+
+            char port[24];
+            m_sources.add(packet.source, int(std::strlen(packet.source)));
+            m_ports.add(port, portKey(packet, port));
+            if (packet.zone[0]) m_zones.add(packet.zone, int(std::strlen(packet.zone)));
+            else m_zones.add("FINAL_REJECT", 12);
+        }
+        p = newline + 1;
+    }
+
+    return p - data;
+}
+
+DeniedLogStore::Snapshot DeniedLogStore::snapshot(quint64 since, int limit, int topN) const
+{
+    QMutexLocker lock(&m_mutex);
+
+    Snapshot out;
+    out.written = m_written;
+    out.lines = m_lines;
+    out.denied = m_sources.total();
+
+    // Whatever the ring still holds, then no more than the caller shows
+    quint64 first = std::max({since, m_clearedAt, m_written > Capacity ? m_written - Capacity : 0});
+    if (m_written - first > quint64(limit)) first = m_written - limit;
+
+    out.packets.reserve(int(m_written - first));
+    for (quint64 i = first; i < m_written; ++i) out.packets.append(m_ring[i % Capacity]);
+
+    out.sources = m_sources.top(topN);
+    out.ports = m_ports.top(topN);
+    out.zones = m_zones.top(topN);
+    return out;
+}
+
+void DeniedLogStore::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_clearedAt = m_written;
+    m_lines = 0;
+    m_sources.clear();
+    m_ports.clear();
+    m_zones.clear();
+}
+
+// === READER ===
+
+DeniedLogReader::DeniedLogReader(const QString &path, DeniedLogStore *store)
+    : m_path(path)
+    , m_store(store)
+{
+}
+
+void DeniedLogReader::stop()
+{
+    m_stop.store(true, std::memory_order_relaxed);
+}
+
+void DeniedLogReader::run()
+{
+    const int fd = ::open(QFile::encodeName(m_path).constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        emit failed(m_path + ": " + QString::fromLocal8Bit(std::strerror(errno)));
+        return;
+    }
+    const auto closeFd = qScopeGuard([fd]() { ::close(fd); });
+
+    struct stat info{};
+    ::fstat(fd, &info);
+    const bool records = S_ISCHR(info.st_mode); // /dev/kmsg: one record per read()
+    const bool regular = S_ISREG(info.st_mode);
+
+    // Only what the kernel logs from now on, not the whole backlog
+    if (records) ::lseek(fd, 0, SEEK_END);
+
+    constexpr qsizetype BufferSize = 64 * 1024;
+    constexpr qsizetype RecordRoom = 8 * 1024; // a kmsg read fails unless the whole record fits
+    const std::unique_ptr<char[]> buffer(new char[BufferSize]);
+    qsizetype filled = 0;
+
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        const ssize_t got = ::read(fd, buffer.get() + filled, std::size_t(BufferSize - filled));
+        const int error = got < 0 ? errno : 0;
+
+        if (got > 0) {
+            filled += got;
+            // Keep gathering while there is room; one feed() per buffer keeps the lock rare
+            if (BufferSize - filled >= (records ? RecordRoom : 1)) continue;
+        } else if (error == EINTR || (records && error == EPIPE)) {
+            continue; // EPIPE: records overwritten before we got to them; the next read skips ahead
+        } else if (got < 0 && error != EAGAIN) {
+            emit failed(m_path + ": " + QString::fromLocal8Bit(std::strerror(error)));
+            return;
+        }
+
+        // 1. Hand over every complete line; a partial one moves to the front
+        if (filled > 0) {
+            const qsizetype used = m_store->feed(buffer.get(), filled, QDateTime::currentMSecsSinceEpoch());
+            filled -= used;
+            if (filled == BufferSize) filled = 0; // one line longer than the buffer; not a netfilter line
+            else if (used > 0) std::memmove(buffer.get(), buffer.get() + used, std::size_t(filled));
+        }
+        if (got > 0) continue;
+
+        // 2. Caught up: a file is polled for growth, a FIFO or kmsg waited on
+        if (regular || got == 0) {
+            QThread::msleep(IDLE_WAIT_MS);
+        } else {
+            pollfd waiting{fd, POLLIN, 0};
+            ::poll(&waiting, 1, IDLE_WAIT_MS);
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+// One packet firewalld logged as denied. Fixed-size, so the ring never allocates.
+struct DeniedPacket {
+    qint64 timeMs = 0;     // when it was read, wall clock
+    char zone[32] = {};    // empty for FINAL_REJECT
+    char chain[8] = {};    // "IN", "FWD", "FINAL"
+    char action[8] = {};   // "REJECT", "DROP"
+    char interface[16] = {};
+    char source[40] = {};
+    char destination[40] = {};
+    char protocol[8] = {}; // "TCP", "UDP", "ICMP", ...
+    quint16 sourcePort = 0;
+    quint16 destinationPort = 0;
+
+    // One /dev/kmsg, dmesg or syslog line; false unless it is a firewalld denial
+    static bool parse(const char *begin, const char *end, DeniedPacket &out);
+};
+
+// Space-saving top-k: keeps every key seen more than total / Capacity times,
+// counted at most `error` too high
+template <int Capacity, int KeyLength = 40>
+class SpaceSaving
+{
+public:
+    struct Item {
+        QString key;
+        quint64 count = 0;
+        quint64 error = 0;
+    };
+
+    void add(const char *key, int length)
+    {
+        length = std::min(length, KeyLength);
+        const quint64 hash = hashOf(key, length);
+        ++m_total;
+
+        // A linear pass over the hashes is a couple of cache lines at this size
+        for (int i = 0; i < m_used; ++i) {
+            if (m_hashes[i] == hash && m_lengths[i] == length && std::memcmp(m_keys[i].data(), key, length) == 0) {
+                ++m_counts[i];
+                return;
+            }
+        }
+
+        int slot = m_used;
+        quint64 floor = 0;
+        if (m_used < Capacity) {
+            ++m_used;
+        } else {
+            // The smallest counter hands its count over as the newcomer's error
+            slot = 0;
+            for (int i = 1; i < Capacity; ++i) if (m_counts[i] < m_counts[slot]) slot = i;
+            floor = m_counts[slot];
+        }
+
+        m_hashes[slot] = hash;
+        m_lengths[slot] = quint8(length);
+        std::memcpy(m_keys[slot].data(), key, length);
+        m_counts[slot] = floor + 1;
+        m_errors[slot] = floor;
+    }
+
+    // Highest counts first
+    QList<Item> top(int n) const
+    {
+        std::array<int, Capacity> order;
+        for (int i = 0; i < m_used; ++i) order[i] = i;
+        n = std::min(n, m_used);
+        std::partial_sort(order.begin(), order.begin() + n, order.begin() + m_used,
+                          [this](int a, int b) { return m_counts[a] > m_counts[b]; });
+
+        QList<Item> out;
+        out.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            const int slot = order[i];
+            out.append({QString::fromLatin1(m_keys[slot].data(), m_lengths[slot]), m_counts[slot], m_errors[slot]});
+        }
+        return out;
+    }
+
+    quint64 total() const { return m_total; }
+
+    void clear()
+    {
+        m_used = 0;
+        m_total = 0;
+    }
+
+private:
+    static quint64 hashOf(const char *key, int length)
+    {
+        quint64 hash = 14695981039346656037ULL; // FNV-1a
+        for (int i = 0; i < length; ++i) hash = (hash ^ quint8(key[i])) * 1099511628211ULL;
+        return hash;
+    }
+
+    std::array<quint64, Capacity> m_hashes{};
+    std::array<quint64, Capacity> m_counts{};
+    std::array<quint64, Capacity> m_errors{};
+    std::array<quint8, Capacity> m_lengths{};
+    std::array<std::array<char, KeyLength>, Capacity> m_keys{};
+    int m_used = 0;
+    quint64 m_total = 0;
+};
+
+// Last Capacity denials plus top sources, ports and zones, in fixed memory.
+// Locked once per chunk fed in.
+class DeniedLogStore
+{
+public:
+    static constexpr int Capacity = 4096;
+    static constexpr int TopCapacity = 64;
+
+    using Top = SpaceSaving<TopCapacity>;
+
+    struct Snapshot {
+        QList<DeniedPacket> packets; // newest last, only those after `since`
+        quint64 written = 0;         // pass back as `since` next time
+        quint64 lines = 0;
+        quint64 denied = 0;
+        QList<Top::Item> sources;
+        QList<Top::Item> ports;
+        QList<Top::Item> zones;
+    };
+
+    // Parses every complete line; returns the bytes consumed
+    qsizetype feed(const char *data, qsizetype size, qint64 timeMs);
+
+    // At most `limit` packets and `topN` entries per summary
+    Snapshot snapshot(quint64 since, int limit, int topN) const;
+
+    void clear();
+
+private:
+    mutable QMutex m_mutex;
+    std::array<DeniedPacket, Capacity> m_ring;
+    quint64 m_written = 0;
+    quint64 m_clearedAt = 0; // packets before this stay out of snapshots
+    quint64 m_lines = 0;
+    Top m_sources;
+    Top m_ports;
+    Top m_zones;
+};
+
+// Follows /dev/kmsg (or, for tests, a file or FIFO) on its own thread through one fixed buffer
+class DeniedLogReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    DeniedLogReader(const QString &path, DeniedLogStore *store);
+
+    void run(); // reader thread; returns once stop() is called or the source fails
+    void stop(); // any thread
+
+signals:
+    void failed(const QString &error);
+
+private:
+    QString m_path;
+    DeniedLogStore *m_store;
+    std::atomic<bool> m_stop{false};
+};
@@ -0,0 +1,160 @@
+#include "deniedlogmodel.h"
+
+#include <QDateTime>
+#include <QThread>
+#include <QTimer>
+
+// How often an open viewer takes in new packets, and how many it keeps
+const int UPDATE_INTERVAL_MS = 250;
+const int MAX_ROWS = 500;
+const int TOP_N = 10;
+
+static QVariantList topToList(const QList<DeniedLogStore::Top::Item> &items)
+{
+    QVariantList out;
+    out.reserve(items.size());
+    for (const DeniedLogStore::Top::Item &item : items) {
+        out.append(QVariantMap{
+            {"key", item.key},
+            {"count", double(item.count)},
+            {"error", double(item.error)}, // the count may be this much too high
+        });
+    }
+    return out;
+}
+
+DeniedLogModel::DeniedLogModel(const QString &path, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_path(path)
+    , m_store(std::make_unique<DeniedLogStore>())
+{
+    m_timer = new QTimer(this);
+    m_timer->setInterval(UPDATE_INTERVAL_MS);
+    connect(m_timer, &QTimer::timeout, this, &DeniedLogModel::update);
+}
+
+DeniedLogModel::~DeniedLogModel()
+{
+    if (!m_thread) return;
+    m_reader->stop();
+    m_thread->quit();
+    m_thread->wait();
+}
+
+int DeniedLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant DeniedLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid)) return QVariant();
+
+    const DeniedPacket &packet = m_rows.at(index.row());
+    switch (role) {
+    case TimeRole: return QDateTime::fromMSecsSinceEpoch(packet.timeMs);
+    case ZoneRole: return QString::fromUtf8(packet.zone);
+    case ChainRole: return QString::fromLatin1(packet.chain);
+    case ActionRole: return QString::fromLatin1(packet.action);
+    case InterfaceRole: return QString::fromUtf8(packet.interface);
+    case Qt::DisplayRole:
+    case SourceRole: return QString::fromLatin1(packet.source);
+    case DestinationRole: return QString::fromLatin1(packet.destination);
+    case ProtocolRole: return QString::fromLatin1(packet.protocol);
+    case SourcePortRole: return packet.sourcePort;
+    case DestinationPortRole: return packet.destinationPort;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> DeniedLogModel::roleNames() const
+{
+    return {
+        {TimeRole, "time"},
+        {ZoneRole, "zone"},
+        {ChainRole, "chain"},
+        {ActionRole, "action"},
+        {InterfaceRole, "interface"},
+        {SourceRole, "source"},
+        {DestinationRole, "destination"},
+        {ProtocolRole, "protocol"},
+        {SourcePortRole, "sourcePort"},
+        {DestinationPortRole, "destinationPort"},
+    };
+}
+
+void DeniedLogModel::setActive(bool active)
+{
+    if (m_active == active) return;
+    m_active = active;
+
+    if (active) {
+        if (!m_thread) start();
+        update();
+        m_timer->start();
+    } else {
+        m_timer->stop();
+    }
+    emit activeChanged();
+}
+
+void DeniedLogModel::start()
+{
+    m_thread = new QThread(this);
+    m_thread->setObjectName(QStringLiteral("cinderward-deniedlog"));
+    m_reader = new DeniedLogReader(m_path, m_store.get());
+    m_reader->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_reader, &QObject::deleteLater);
+
+    connect(m_reader, &DeniedLogReader::failed, this, [this](const QString &error) {
+        m_error = error;
+        emit errorChanged();
+    });
+
+    m_thread->start(QThread::LowPriority);
+    QMetaObject::invokeMethod(m_reader, &DeniedLogReader::run, Qt::QueuedConnection);
+}
+
+void DeniedLogModel::update()
+{
+    const DeniedLogStore::Snapshot snapshot = m_store->snapshot(m_seen, MAX_ROWS, TOP_N);
+    m_seen = snapshot.written;
+
+    // 1. New packets go on top in one insert; the oldest fall off the bottom
+    const int fresh = snapshot.packets.size();
+    if (fresh > 0) {
+        beginInsertRows(QModelIndex(), 0, fresh - 1);
+        for (const DeniedPacket &packet : snapshot.packets) m_rows.prepend(packet);
+        endInsertRows();
+    }
+    if (m_rows.size() > MAX_ROWS) {
+        beginRemoveRows(QModelIndex(), MAX_ROWS, m_rows.size() - 1);
+        m_rows.resize(MAX_ROWS);
+        endRemoveRows();
+    }
+
+    // 2. Totals and rate
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_lastTickMs > 0 && now > m_lastTickMs && snapshot.lines >= m_lastLines)
+        m_linesPerSecond = double(snapshot.lines - m_lastLines) * 1000.0 / double(now - m_lastTickMs);
+    m_lastTickMs = now;
+    m_lastLines = snapshot.lines;
+    m_denied = snapshot.denied;
+
+    m_topSources = topToList(snapshot.sources);
+    m_topPorts = topToList(snapshot.ports);
+    m_topZones = topToList(snapshot.zones);
+    emit updated();
+}
+
+void DeniedLogModel::clear()
+{
+    m_store->clear();
+    m_lastLines = 0;
+
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+
+    update();
+}
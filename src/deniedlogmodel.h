@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QVariantList>
+
+#include <memory>
+
+#include "deniedlog.h"
+
+class QThread;
+class QTimer;
+
+// Denied packets, newest first, and the top sources, ports and zones. Reading starts
+// the first time `active` is set; the view refreshes on a timer only while active.
+class DeniedLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(QString error READ error NOTIFY errorChanged)
+    Q_PROPERTY(QVariantList topSources READ topSources NOTIFY updated)
+    Q_PROPERTY(QVariantList topPorts READ topPorts NOTIFY updated)
+    Q_PROPERTY(QVariantList topZones READ topZones NOTIFY updated)
+    Q_PROPERTY(double totalDenied READ totalDenied NOTIFY updated)
+    Q_PROPERTY(double linesPerSecond READ linesPerSecond NOTIFY updated)
+
+public:
+    enum Roles {
+        TimeRole = Qt::UserRole + 1, // QDateTime
+        ZoneRole,
+        ChainRole,
+        ActionRole,
+        InterfaceRole,
+        SourceRole,
+        DestinationRole,
+        ProtocolRole,
+        SourcePortRole,
+        DestinationPortRole,
+    };
+    Q_ENUM(Roles)
+
+    // `path` is /dev/kmsg, or a file or FIFO standing in for it
+    explicit DeniedLogModel(const QString &path, QObject *parent = nullptr);
+    ~DeniedLogModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool active() const { return m_active; }
+    void setActive(bool active);
+    QString error() const { return m_error; }
+    QVariantList topSources() const { return m_topSources; }
+    QVariantList topPorts() const { return m_topPorts; }
+    QVariantList topZones() const { return m_topZones; }
+    double totalDenied() const { return double(m_denied); }
+    double linesPerSecond() const { return m_linesPerSecond; }
+
+    Q_INVOKABLE void clear();
+
+signals:
+    void activeChanged();
+    void errorChanged();
+    void updated();
+
+private:
+    void start();
+    void update();
+
+    QString m_path;
+    std::unique_ptr<DeniedLogStore> m_store; // large; the reader writes, update() reads
+    DeniedLogReader *m_reader = nullptr;
+    QThread *m_thread = nullptr;
+    QTimer *m_timer = nullptr;
+
+    bool m_active = false;
+    QString m_error;
+
+    QList<DeniedPacket> m_rows; // newest first
+    quint64 m_seen = 0;
+    quint64 m_denied = 0;
+    quint64 m_lastLines = 0;
+    qint64 m_lastTickMs = 0;
+    double m_linesPerSecond = 0;
+    QVariantList m_topSources;
+    QVariantList m_topPorts;
+    QVariantList m_topZones;
+};
@@ -1,74 +1,337 @@
 #include "firewallbackend.h"
-#include <QDBusConnection>
-#include <QDBusReply>
-#include <QDBusMessage>
+#include "configwriter.h"
+#include "firewallconnection.h"
+#include "zonesettings.h"
+#include "writescheduler.h"
+#include "snapshotcache.h"
+#include "socketinventory.h"
+#include "startuptiming.h"
+#include "sourceimport.h"
+#include "policy.h"
+#include "firewalld_interface.h"
+#include "firewalld_zone_interface.h"
+#include "firewalld_config_interface.h"
+#include "firewalld_config_zone_interface.h"
+#include "firewalld_config_ipset_interface.h"
 #include <QDBusArgument>
+#include <QDBusMetaType>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
 #include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QRegularExpression>
 
-// Constants for Firewalld D-Bus
+#include <algorithm>
+#include <utility>
 
-const QString FW_SERVICE = "org.fedoraproject.FirewallD1";
-const QString FW_PATH = "/org/fedoraproject/FirewallD1";
-const QString FW_INTERFACE = "org.fedoraproject.FirewallD1";
-const QString FW_ZONE_INTERFACE = "org.fedoraproject.FirewallD1.zone";
+// How long a toggle waits for a newer state before it is sent
+const int WRITE_DEBOUNCE_MS = 150;
 
-// Permanent Config Constants
+// How often the listening sockets behind open ports are checked again
+const int SOCKET_SCAN_MS = 5000;
 
-const QString FW_CONFIG_PATH = "/org/fedoraproject/FirewallD1/config";
-const QString FW_CONFIG_INTERFACE = "org.fedoraproject.FirewallD1.config";
-const QString FW_CONFIG_ZONE_INTERFACE = "org.fedoraproject.FirewallD1.config.zone";
+// New entries per setEntries call when an import fills an ipset
+const int IPSET_ENTRY_CHUNK = 4096;
+
+// Where denied packets are logged; a file or FIFO can stand in, see main.cpp
+const char *const DENIED_LOG_DEFAULT = "/dev/kmsg";
 
 FirewallBackend::FirewallBackend(QObject *parent)
+    : FirewallBackend(new FirewallConnection(QDBusConnection::SystemBus), parent)
+{
+}
+
+FirewallBackend::FirewallBackend(FirewallConnection *bus, QObject *parent)
     : QObject(parent)
+    , m_bus(bus)
 {
-    QDBusConnection bus = QDBusConnection::systemBus();
-    if (bus.isConnected()) {
-        QDBusInterface fw(FW_SERVICE, FW_PATH, FW_INTERFACE, bus);
-        
-        QDBusReply<QStringList> reply = fw.call("listServices");
-        
-        if (reply.isValid()) {
-            m_knownServices = reply.value();
-            m_knownServices.sort(); 
-        } else {
-            qWarning() << "Failed to load services:" << reply.error().message();
+    registerZoneSettingsTypes();
+
+    // Every bus call, reply decode and signal subscription runs on the worker thread
+    m_bus->setParent(this);
+
+    m_writes = new WriteScheduler(WRITE_DEBOUNCE_MS, this);
+    m_writer = new ConfigWriter(m_bus, this);
+    m_rules = new RuleListModel(this);
+    m_catalog = new ServiceCatalog(m_bus, this);
+    m_callStats = new CallStatsModel(m_bus->trace(), this);
+    m_sockets = new SocketInventory(SOCKET_SCAN_MS, this);
+
+    const QString deniedLog = qEnvironmentVariable("CINDERWARD_DENIED_LOG", DENIED_LOG_DEFAULT);
+    m_deniedLog = new DeniedLogModel(deniedLog, this);
+
+    // Service ports feed the port index and the listener lookup
+    connect(m_catalog, &ServiceCatalog::loadingChanged, this, [this]() {
+        if (m_catalog->loading()) return;
+        markZonesChanged();
+        updateListeners();
+    });
+    connect(m_sockets, &SocketInventory::changed, this, &FirewallBackend::updateListeners);
+
+    // Paint the last known state right away; live data replaces it as it arrives
+    loadCache();
+    loadKnownServices();
+
+    connectChangeSignals();
+
+    // Toggles are shown immediately; a failed write puts back what firewalld really has
+    connect(m_writes, &WriteScheduler::failed, this, [this](const QString &lane) {
+        if (lane.isEmpty()) refresh(m_snapshot.zoneName);
+        else syncZone(lane);
+    });
+    connect(m_writes, &WriteScheduler::idle, this, [this](const QString &lane) {
+        if (m_resyncAfterWrites.remove(lane)) syncZone(lane);
+    });
+}
+
+// === STARTUP CACHE ===
+
+void FirewallBackend::loadCache()
+{
+    CachedState cached;
+    if (!SnapshotCache::load(cached)) {
+        StartupTiming::mark("no usable state cache");
+        return;
+    }
+
+    m_cachedVersion = cached.firewalldVersion;
+    m_showingCache = true;
+    m_zoneSettings = cached.zones;
+    markZonesChanged();
+    setZones(cached.zoneNames);
+    setKnownServices(cached.knownServices);
+
+    Snapshot snapshot;
+    snapshot.defaultZone = cached.defaultZone;
+    snapshot.zoneName = cached.defaultZone; // where a live start lands too
+    snapshot.panic = cached.panic;
+    snapshot.logDenied = cached.logDenied;
+    snapshot.zoneFound = m_zoneSettings.contains(snapshot.zoneName);
+    snapshot.zone = m_zoneSettings.value(snapshot.zoneName);
+    applySnapshot(snapshot);
+
+    StartupTiming::mark("state cache shown");
+}
+
+void FirewallBackend::saveCache()
+{
+    // Nothing live yet; the file on disk is already what we'd write
+    if (m_showingCache) return;
+
+    CachedState state;
+    state.firewalldVersion = m_firewalldVersion;
+    state.configGeneration = SnapshotCache::configGeneration();
+    state.defaultZone = m_snapshot.defaultZone;
+    state.panic = m_snapshot.panic;
+    state.logDenied = m_snapshot.logDenied;
+    state.zoneNames = m_zones;
+    state.zones = m_zoneSettings;
+    state.knownServices = m_knownServices;
+    SnapshotCache::save(state);
+}
+
+// Plain Properties.Get; the generated property accessor blocks
+void FirewallBackend::checkFirewalldVersion()
+{
+    m_bus->call(DBusCall::mainProperty("version"), [this](const DBusResult &reply) {
+        if (reply.isError()) return;
+        m_firewalldVersion = reply.arguments.value(0).value<QDBusVariant>().variant().toString();
+
+        // Written by another firewalld: its settings may not mean the same thing here
+        if (!m_showingCache || m_cachedVersion.isEmpty() || m_cachedVersion == m_firewalldVersion) return;
+
+        qWarning() << "Dropping state cache from firewalld" << m_cachedVersion << "- running" << m_firewalldVersion;
+        SnapshotCache::discard();
+        m_showingCache = false;
+        m_zoneSettings.clear();
+        m_pendingZones.clear();
+        markZonesChanged();
+        setZones({});
+        updateSnapshot([](Snapshot &s) {
+            s.zoneFound = false;
+            s.zone = ZoneSettings();
+        });
+    });
+}
+
+void FirewallBackend::loadKnownServices()
+{
+    m_bus->call(DBusCall::main("listServices", [](auto *fw) { return fw->listServices(); }), [this](const DBusResult &reply) {
+        if (reply.isError()) {
+            qWarning() << "Failed to load services:" << reply.error.message();
+            return;
         }
+
+        QStringList services = reply.arguments.value(0).toStringList();
+        services.sort();
+        setKnownServices(services);
+        saveCache();
+        StartupTiming::mark("service list loaded");
+    });
+}
+
+// === CHANGE SIGNALS ===
+
+void FirewallBackend::connectChangeSignals()
+{
+    // 1. Globals. The viewed zone stays put; only the default marker moves.
+    connect(m_bus, &FirewallConnection::defaultZoneChanged, this, [this](const QString &zone) {
+        updateSnapshot([&zone](Snapshot &s) { s.defaultZone = zone; });
+    });
+    connect(m_bus, &FirewallConnection::panicChanged, this, [this](bool enabled) {
+        updateSnapshot([enabled](Snapshot &s) { s.panic = enabled; });
+    });
+    connect(m_bus, &FirewallConnection::logDeniedChanged, this, [this](const QString &value) {
+        updateSnapshot([&value](Snapshot &s) { s.logDenied = value; });
+    });
+
+    // 2. Reloaded, or a zone came or went: re-read the lot
+    connect(m_bus, &FirewallConnection::zonesChanged, this, [this]() { refresh(m_snapshot.zoneName); });
+
+    // 3. One zone's permanent config changed: re-read that zone
+    connect(m_bus, &FirewallConnection::zoneUpdated, this, &FirewallBackend::syncZone);
+}
+
+void FirewallBackend::updateSnapshot(const std::function<void(Snapshot &)> &change)
+{
+    Snapshot next = m_snapshot;
+    change(next);
+    applySnapshot(next);
+}
+
+// Our own toggles, shown before firewalld has them. The permanent map is left alone.
+void FirewallBackend::patchZone(const QString &zone, const std::function<bool(ZoneSettings &)> &patch)
+{
+    auto permanent = m_zoneSettings.constFind(zone);
+    if (permanent == m_zoneSettings.constEnd()) return;
+
+    ZoneSettings view = m_pendingZones.value(zone, *permanent);
+    if (!patch(view)) return;
+    m_pendingZones.insert(zone, view);
+    if (zone == m_snapshot.zoneName) showZone(zone);
+}
+
+ZoneSettings FirewallBackend::zoneView(const QString &zone) const
+{
+    auto pending = m_pendingZones.constFind(zone);
+    return pending != m_pendingZones.constEnd() ? *pending : m_zoneSettings.value(zone);
+}
+
+// The view is always a copy of the map entry, so switching never touches the bus
+void FirewallBackend::showZone(const QString &zone)
+{
+    const bool found = m_zoneSettings.contains(zone);
+    const ZoneSettings view = zoneView(zone);
+
+    updateSnapshot([&](Snapshot &s) {
+        s.zoneName = zone;
+        s.zoneFound = found;
+        s.zone = view;
+    });
+}
+
+void FirewallBackend::storeZone(const QString &zone, bool found, const ZoneSettings &settings)
+{
+    if (found) m_zoneSettings.insert(zone, settings);
+    else m_zoneSettings.remove(zone);
+    m_pendingZones.remove(zone); // only re-read once our toggles have landed
+    markZonesChanged();
+
+    if (zone == m_snapshot.zoneName) showZone(zone);
+}
+
+// === LISTENING SOCKETS ===
+
+void FirewallBackend::updateListeners()
+{
+    m_rules->setListeners(m_sockets->table(), [this](const QString &service) { return m_catalog->portsFor(service); });
+}
+
+// === PORT INDEX ===
+
+void FirewallBackend::markZonesChanged()
+{
+    m_portIndexDirty = true;
+    m_configRevision++;
+    emit configRevisionChanged();
+}
+
+// Rebuilt on the first query after a change, not on every signal
+const PortIndex &FirewallBackend::portIndex()
+{
+    if (m_portIndexDirty) {
+        m_portIndex.rebuild(m_zoneSettings, [this](const QString &service) { return m_catalog->portsFor(service); });
+        m_portIndexDirty = false;
     }
+    return m_portIndex;
 }
 
-// === HELPER: Get Permanent Zone Path ===
+static QVariantMap portEntryToMap(const PortIndex::Entry &entry)
+{
+    static const char *const kinds[] = {"port", "service", "forward"};
+    return QVariantMap{
+        {"zone", entry.zone},
+        {"kind", kinds[entry.kind]},
+        {"item", entry.item},
+        {"protocol", entry.protocol},
+        {"first", entry.first},
+        {"last", entry.last},
+    };
+}
 
-QString FirewallBackend::getPermanentZonePath(const QString &zoneName)
+QVariantList FirewallBackend::explainPort(const QString &port, const QString &protocol)
 {
-    // 1. Connect to the Config interface
-    QDBusInterface config(FW_SERVICE, FW_CONFIG_PATH, FW_CONFIG_INTERFACE, QDBusConnection::systemBus());
-    
-    // 2. Ask for the object path of the specific zone by name
-    QDBusReply<QDBusObjectPath> reply = config.call("getZoneByName", zoneName);
-    if (reply.isValid()) {
-        return reply.value().path();
+    int first = 0, last = 0;
+    if (!PortIndex::parseRange(port, first, last)) return {};
+
+    QVariantList reasons;
+    for (const PortIndex::Entry &entry : portIndex().overlapping(protocol.toLower(), first, last))
+        reasons.append(portEntryToMap(entry));
+    return reasons;
+}
+
+QVariantList FirewallBackend::redundantPorts(const QString &zone)
+{
+    QVariantList found;
+    for (const PortIndex::Redundancy &r : portIndex().redundant(zone)) {
+        QVariantMap entry = portEntryToMap(r.entry);
+        entry.insert("coveredBy", portEntryToMap(r.coveredBy));
+        found.append(entry);
     }
-    return QString();
+    return found;
 }
 
 // === GETTERS ===
 
 QString FirewallBackend::state() const { return m_state; }
 QString FirewallBackend::defaultZone() const { return m_defaultZone; }
+QString FirewallBackend::currentZone() const { return m_currentZone; }
+QStringList FirewallBackend::zones() const { return m_zones; }
 QStringList FirewallBackend::services() const { return m_services; }
 QStringList FirewallBackend::ports() const { return m_ports; }
 QStringList FirewallBackend::forwardRules() const { return m_forwardRules; }
+RuleListModel *FirewallBackend::rules() const { return m_rules; }
 QStringList FirewallBackend::knownServices() const { return m_knownServices; }
+ServiceCatalog *FirewallBackend::serviceCatalog() const { return m_catalog; }
+CallStatsModel *FirewallBackend::callStats() const { return m_callStats; }
+DeniedLogModel *FirewallBackend::deniedLog() const { return m_deniedLog; }
 QStringList FirewallBackend::sources() const { return m_sources; }
 bool FirewallBackend::masquerade() const { return m_masquerade; }
 bool FirewallBackend::logDenied() const { return m_logDenied; }
 bool FirewallBackend::panic() const { return m_panic; }
 bool FirewallBackend::stealthMode() const { return m_stealthMode; }
 bool FirewallBackend::strictIcmp() const { return m_strictIcmp; }
+bool FirewallBackend::busy() const { return m_busy; }
+bool FirewallBackend::batchActive() const { return m_batchActive; }
+bool FirewallBackend::importing() const { return m_importing; }
+int FirewallBackend::configRevision() const { return m_configRevision; }
 
 // === SETTERS (Internal) ===
 void FirewallBackend::setState(const QString &s) { if (m_state != s) { m_state = s; emit stateChanged(); } }
 void FirewallBackend::setDefaultZone(const QString &z) { if (m_defaultZone != z) { m_defaultZone = z; emit defaultZoneChanged(); } }
+void FirewallBackend::setCurrentZone(const QString &z) { if (m_currentZone != z) { m_currentZone = z; emit currentZoneChanged(); } }
+void FirewallBackend::setZones(const QStringList &z) { if (m_zones != z) { m_zones = z; emit zonesChanged(); } }
 void FirewallBackend::setServices(const QStringList &s) { if (m_services != s) { m_services = s; emit servicesChanged(); } }
 void FirewallBackend::setPorts(const QStringList &p) { if (m_ports != p) { m_ports = p; emit portsChanged(); } }
 void FirewallBackend::setForwardRules(const QStringList &r) { if (m_forwardRules != r) { m_forwardRules = r; emit forwardRulesChanged(); } }
@@ -77,294 +340,798 @@ void FirewallBackend::setLogDeniedState(bool enabled) { if (m_logDenied != enabl
 void FirewallBackend::setPanicState(bool enabled) { if (m_panic != enabled) { m_panic = enabled; emit panicChanged(); } }
 void FirewallBackend::setStealthModeState(bool enabled) { if (m_stealthMode != enabled) { m_stealthMode = enabled; emit stealthModeChanged(); } }
 void FirewallBackend::setStrictIcmpState(bool enabled) { if (m_strictIcmp != enabled) { m_strictIcmp = enabled; emit strictIcmpChanged(); } }
+void FirewallBackend::setKnownServices(const QStringList &s) { if (m_knownServices != s) { m_knownServices = s; m_catalog->setServices(s); emit knownServicesChanged(); } }
 void FirewallBackend::setSources(const QStringList &s) { if (m_sources != s) { m_sources = s; emit sourcesChanged(); } }
+void FirewallBackend::setBusy(bool busy) { if (m_busy != busy) { m_busy = busy; emit busyChanged(); } }
+void FirewallBackend::setBatchActive(bool active) { if (m_batchActive != active) { m_batchActive = active; emit batchActiveChanged(); } }
+void FirewallBackend::setImporting(bool importing) { if (m_importing != importing) { m_importing = importing; emit importingChanged(); } }
 
 // === REFRESH LOGIC (Permanent-based) ===
 
+// The QML side still consumes the flat "port/proto" and "port=..:proto=.." strings
+static QStringList portStrings(const QList<ZonePort> &ports)
+{
+    QStringList portList;
+    portList.reserve(ports.size());
+    for (const ZonePort &p : ports) portList.append(p.port + "/" + p.protocol);
+    return portList;
+}
+
+static QStringList forwardRuleStrings(const QList<ForwardPort> &forwardPorts)
+{
+    QStringList fwdList;
+    fwdList.reserve(forwardPorts.size());
+    for (const ForwardPort &f : forwardPorts) {
+        QString rule = QString("port=%1:proto=%2:toport=%3").arg(f.port, f.protocol, f.toPort);
+        if (!f.toAddr.isEmpty()) rule += QString(":toaddr=%1").arg(f.toAddr);
+        fwdList.append(rule);
+    }
+    return fwdList;
+}
+
 void FirewallBackend::refresh(const QString &zone)
 {
-    QDBusConnection bus = QDBusConnection::systemBus();
-    if (!bus.isConnected()) {
-        emit operationError("Cannot connect to system bus");
-        setState("error");
+    setState("running");
+
+    // A newer refresh supersedes this one; a stale state is dropped on arrival
+    const quint64 generation = ++m_refreshGeneration;
+    m_zoneReads.clear();
+    setBusy(true);
+
+    if (m_firewalldVersion.isEmpty()) checkFirewalldVersion();
+
+    // Globals and every zone in one read, so switching zones never waits on the bus
+    m_bus->readState([this, generation, zone](const FirewallStatePtr &state) {
+        if (generation == m_refreshGeneration) finishRefresh(zone, state);
+    });
+}
+
+// Shows a zone from the prefetched map. The default zone is left alone.
+void FirewallBackend::viewZone(const QString &zone)
+{
+    if (zone.isEmpty() || zone == m_snapshot.zoneName) return;
+
+    showZone(zone);
+
+    // Created since the last prefetch; fill it in
+    if (!m_zoneSettings.contains(zone)) syncZone(zone);
+}
+
+// Re-reads a single zone into the map. Used by change signals.
+void FirewallBackend::syncZone(const QString &zoneName)
+{
+    if (zoneName.isEmpty()) return;
+
+    // A re-read between two queued toggles would flash the older state
+    if (!m_writes->isIdle(zoneName)) {
+        m_resyncAfterWrites.insert(zoneName);
         return;
     }
 
-    QDBusInterface fw(FW_SERVICE, FW_PATH, FW_INTERFACE, bus);
+    // Let an in-flight refresh land first, then re-read on top of it
+    if (m_busy) {
+        m_resyncZones.insert(zoneName);
+        return;
+    }
 
-    // 1. Get State & Panic
-    setState("running");
+    // Only the newest read of each zone may land; other zones are unaffected
+    const quint64 generation = ++m_zoneReadGeneration;
+    m_zoneReads.insert(zoneName, generation);
 
-    QDBusReply<bool> panicReply = fw.call("queryPanicMode");
-    if (panicReply.isValid()) setPanicState(panicReply.value());
-
-    // 2. Determine the Zone to Query
-    QDBusReply<QString> defZoneReply = fw.call("getDefaultZone");
-    QString actualZone = zone;
-    
-    // If we passed an empty string (from startup), use the system default
-    if (defZoneReply.isValid()) {
-        setDefaultZone(defZoneReply.value());
-        if (actualZone.isEmpty()) actualZone = defZoneReply.value(); 
-    } else {
-        if (actualZone.isEmpty()) actualZone = m_defaultZone;
-    }
+    m_bus->readZone(zoneName, [this, zoneName, generation](bool found, const ZoneSettings &settings) {
+        if (m_zoneReads.value(zoneName) != generation) return;
+        m_zoneReads.remove(zoneName);
+        storeZone(zoneName, found, settings);
+    });
+}
 
-    // A. Permanent Path (REQUIRED for Services/Ports)
-    QString permanentZonePath = getPermanentZonePath(actualZone);
-    if (permanentZonePath.isEmpty()) {
-        setServices({}); setPorts({}); setForwardRules({});
+void FirewallBackend::finishRefresh(const QString &zone, const FirewallStatePtr &state)
+{
+    if (!state) {
+        emit operationError("Cannot connect to system bus");
+        setState("error");
+        setBusy(false);
+        m_resyncZones.clear();
         return;
     }
-    QDBusInterface permanentZoneIf(FW_SERVICE, permanentZonePath, FW_CONFIG_ZONE_INTERFACE, bus);
-
-    // 4. Services (Always from Permanent)
-    QDBusReply<QStringList> servicesReply = permanentZoneIf.call("getServices");
-    if (servicesReply.isValid()) setServices(servicesReply.value());
-    else setServices({});
-
-    // 5. Ports (Always from Permanent)
-    QDBusMessage portsMsg = permanentZoneIf.call("getPorts");
-    if (portsMsg.type() == QDBusMessage::ReplyMessage) {
-        const QDBusArgument &arg = portsMsg.arguments().at(0).value<QDBusArgument>();
-        QStringList portList;
-        arg.beginArray();
-        while (!arg.atEnd()) {
-            QString port, proto;
-            arg.beginStructure();
-            arg >> port >> proto;
-            arg.endStructure();
-            portList.append(port + "/" + proto);
+
+    // A failed read says nothing about the zones; keep the ones we had
+    if (!state->complete) {
+        qWarning() << "Incomplete firewalld read; keeping the previous zones";
+        QHash<QString, ZoneSettings> zones = state->zones;
+        for (auto it = m_zoneSettings.constBegin(); it != m_zoneSettings.constEnd(); ++it) {
+            const bool listed = state->zoneNames.isEmpty() || state->zoneNames.contains(it.key());
+            if (listed && !zones.contains(it.key())) zones.insert(it.key(), it.value());
         }
-        arg.endArray();
-        setPorts(portList);
+        m_zoneSettings = zones;
     } else {
-        setPorts({});
+        m_zoneSettings = state->zones;
     }
 
-    // 6. Sources
-
-    QDBusReply<QStringList> sourcesReply = permanentZoneIf.call("getSources");
-    setSources(sourcesReply.isValid() ? sourcesReply.value() : QStringList());
-
-    // 7. Forward Ports (Always from Permanent)
-    QDBusMessage fwdMsg = permanentZoneIf.call("getForwardPorts");
-    if (fwdMsg.type() == QDBusMessage::ReplyMessage) {
-        const QDBusArgument &arg = fwdMsg.arguments().at(0).value<QDBusArgument>();
-        QStringList fwdList;
-        arg.beginArray();
-        while (!arg.atEnd()) {
-            QString p, proto, toP, toAddr;
-            arg.beginStructure();
-            arg >> p >> proto >> toP >> toAddr;
-            arg.endStructure();
-
-            QString rule = QString("port=%1:proto=%2:toport=%3").arg(p, proto, toP);
-            if (!toAddr.isEmpty()) rule += QString(":toaddr=%1").arg(toAddr);
-            fwdList.append(rule);
+    // Zones with toggles still queued keep showing them until re-read
+    for (auto it = m_pendingZones.begin(); it != m_pendingZones.end(); ) {
+        if (m_writes->isIdle(it.key()) || !m_zoneSettings.contains(it.key())) {
+            it = m_pendingZones.erase(it);
+        } else {
+            m_resyncAfterWrites.insert(it.key());
+            ++it;
         }
-        arg.endArray();
-        setForwardRules(fwdList);
-    } else {
-        setForwardRules({});
     }
+    markZonesChanged();
+    if (!state->zoneNames.isEmpty() || state->complete) setZones(state->zoneNames);
 
-    // 8. Masquerade (Always from Permanent)
-    QDBusReply<bool> masqReply = permanentZoneIf.call("queryMasquerade");
-    if (masqReply.isValid())
-        setMasqueradeState(masqReply.value());
-    else
-        setMasqueradeState(false);
+    Snapshot next = m_snapshot;
+    next.zoneName = zone;
+    next.panic = state->panic;
+    next.logDenied = state->logDenied;
+    if (!state->defaultZone.isEmpty()) next.defaultZone = state->defaultZone;
 
-    // 9. Stealth Mode (Check if Target is DROP)
-    QDBusReply<QString> targetReply = permanentZoneIf.call("getTarget");
-    setStealthModeState(targetReply.isValid() && targetReply.value() == "DROP");
+    // Startup, or the viewed zone is gone: fall back to the default
+    if (next.zoneName.isEmpty() || !m_zoneSettings.contains(next.zoneName)) next.zoneName = next.defaultZone;
+    next.zoneFound = m_zoneSettings.contains(next.zoneName);
+    next.zone = zoneView(next.zoneName);
 
-    QDBusReply<bool> icmpInvReply = permanentZoneIf.call("getIcmpBlockInversion");
-    setStrictIcmpState(icmpInvReply.isValid() && icmpInvReply.value());
+    applySnapshot(next);
+    setBusy(false);
 
-    // 10. Log Denied (Global)
-    QDBusReply<QString> logDeniedReply = fw.call("getLogDenied");
-    if (logDeniedReply.isValid()) {
-        setLogDeniedState(logDeniedReply.value() != "off");
-    } else {
-        setLogDeniedState(false);
+    if (m_showingCache && state->complete) {
+        m_showingCache = false;
+        StartupTiming::mark("live state shown");
     }
+    // Never let a partial read become the next start's state
+    if (state->complete) saveCache();
+
+    const QSet<QString> queued = std::exchange(m_resyncZones, {});
+    for (const QString &zone : queued) syncZone(zone);
 }
 
-// === MODIFICATION LOGIC (Permanent + Reload) ===
+void FirewallBackend::applySnapshot(const Snapshot &snapshot)
+{
+    m_snapshot = snapshot;
+
+    setPanicState(snapshot.panic);
+    setDefaultZone(snapshot.defaultZone);
+    setCurrentZone(snapshot.zoneName);
+    setLogDeniedState(snapshot.logDenied != "off");
+
+    const ZoneSettings &zone = snapshot.zone;
+    setServices(zone.services);
+    setPorts(portStrings(zone.ports));
+    setSources(zone.sources);
+    setForwardRules(forwardRuleStrings(zone.forwardPorts));
+    m_rules->setZone(zone);
+
+    // Unknown zone: keep the switches, clear what we can't show
+    if (!snapshot.zoneFound) return;
+
+    setMasqueradeState(zone.masquerade);
+    setStealthModeState(zone.target == "DROP");
+    setStrictIcmpState(zone.icmpBlockInversion);
+}
+
+// === MODIFICATION LOGIC (Runtime + Permanent) ===
+// No reload; config.zone Updated brings the view in step
+
+void FirewallBackend::applyBoth(const QString &failure, const QList<DBusCall> &calls,
+                                const WriteScheduler::Done &done)
+{
+    auto remaining = QSharedPointer<int>::create(calls.size());
+    auto firstError = QSharedPointer<QString>::create();
+
+    for (const DBusCall &call : calls) {
+        m_bus->call(call, [this, failure, remaining, firstError, done](const DBusResult &reply) {
+            if (reply.isError() && !isBenignFirewallError(reply.error) && firstError->isEmpty())
+                *firstError = reply.error.message();
+
+            if (--*remaining > 0) return;
+            if (!firstError->isEmpty()) emit operationError(failure + ": " + *firstError);
+            if (done) done(firstError->isEmpty());
+        });
+    }
+}
 
 void FirewallBackend::addSource(const QString &source, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    QDBusReply<void> reply = zoneIf.call("addSource", source);
-    if (!reply.isValid()) emit operationError("Failed: " + reply.error().message());
-    else reload();
+    if (m_batchActive) {
+        stageEdit(zone, "addSource", source, [source](ZoneSettings &z) {
+            if (!z.sources.contains(source)) z.sources.append(source);
+        });
+        return;
+    }
+
+    applyBoth("Failed", {DBusCall::runtimeZone("addSource", [=](auto *z) { return z->addSource(zone, source); }),
+                         DBusCall::configZone(zone, "addSource", [=](auto *z) { return z->addSource(source); })});
 }
 
 void FirewallBackend::removeSource(const QString &source, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    zoneIf.call("removeSource", source);
-    reload();
+    if (m_batchActive) {
+        stageEdit(zone, "removeSource", source, [source](ZoneSettings &z) { z.sources.removeAll(source); });
+        return;
+    }
+
+    applyBoth("Failed to remove source '" + source + "'",
+              {DBusCall::runtimeZone("removeSource", [=](auto *z) { return z->removeSource(zone, source); }),
+               DBusCall::configZone(zone, "removeSource", [=](auto *z) { return z->removeSource(source); })});
 }
 
+// The zone target has no runtime setter, so this is the one edit that still reloads.
 void FirewallBackend::setStealthMode(bool enabled, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    
-    zoneIf.call("setTarget", enabled ? "DROP" : "default");
-    reload();
+    const QString target = enabled ? "DROP" : "default";
+    if (m_batchActive) {
+        stageEdit(zone, "setTarget", target, [target](ZoneSettings &z) { z.target = target; });
+        return;
+    }
+
+    patchZone(zone, [target](ZoneSettings &z) { return std::exchange(z.target, target) != target; });
+
+    m_writes->schedule(zone, "target", [this, zone, target](const WriteScheduler::Done &done) {
+        const auto setTarget = [target](auto *z) { return z->setTarget(target); };
+        m_bus->call(DBusCall::configZone(zone, "setTarget", setTarget), [this, done](const DBusResult &reply) {
+            if (reply.isError()) {
+                emit operationError("Failed to change zone target: " + reply.error.message());
+                done(false);
+                return;
+            }
+            m_bus->call(DBusCall::main("reload", [](auto *fw) { return fw->reload(); }),
+                        [done](const DBusResult &reply) { done(!reply.isError()); });
+        });
+    });
 }
 
 void FirewallBackend::setStrictIcmp(bool enabled, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-
-    if (enabled) {
-        zoneIf.call("addIcmpBlockInversion");
-        zoneIf.call("addIcmpBlock", "destination-unreachable"); 
-        zoneIf.call("addIcmpBlock", "time-exceeded"); 
-        
-    } else {
-        zoneIf.call("removeIcmpBlockInversion");
-        zoneIf.call("removeIcmpBlock", "destination-unreachable");
-        zoneIf.call("removeIcmpBlock", "time-exceeded");
+    if (m_batchActive) {
+        stageEdit(zone, "setStrictIcmp", enabled ? "on" : "off", [enabled](ZoneSettings &z) {
+            z.icmpBlockInversion = enabled;
+            for (const QString &icmp : {QStringLiteral("destination-unreachable"), QStringLiteral("time-exceeded")}) {
+                if (!enabled) z.icmpBlocks.removeAll(icmp);
+                else if (!z.icmpBlocks.contains(icmp)) z.icmpBlocks.append(icmp);
+            }
+        });
+        return;
     }
-    reload();
+
+    patchZone(zone, [enabled](ZoneSettings &z) { return std::exchange(z.icmpBlockInversion, enabled) != enabled; });
+
+    m_writes->schedule(zone, "strictIcmp", [this, zone, enabled](const WriteScheduler::Done &done) {
+        if (enabled) {
+            applyBoth("Failed to enable strict ICMP", {
+                DBusCall::runtimeZone("addIcmpBlockInversion", [=](auto *z) { return z->addIcmpBlockInversion(zone); }),
+                DBusCall::runtimeZone("addIcmpBlock", [=](auto *z) { return z->addIcmpBlock(zone, "destination-unreachable", 0); }),
+                DBusCall::runtimeZone("addIcmpBlock", [=](auto *z) { return z->addIcmpBlock(zone, "time-exceeded", 0); }),
+                DBusCall::configZone(zone, "addIcmpBlockInversion", [](auto *z) { return z->addIcmpBlockInversion(); }),
+                DBusCall::configZone(zone, "addIcmpBlock", [](auto *z) { return z->addIcmpBlock("destination-unreachable"); }),
+                DBusCall::configZone(zone, "addIcmpBlock", [](auto *z) { return z->addIcmpBlock("time-exceeded"); }),
+            }, done);
+        } else {
+            applyBoth("Failed to disable strict ICMP", {
+                DBusCall::runtimeZone("removeIcmpBlockInversion", [=](auto *z) { return z->removeIcmpBlockInversion(zone); }),
+                DBusCall::runtimeZone("removeIcmpBlock", [=](auto *z) { return z->removeIcmpBlock(zone, "destination-unreachable"); }),
+                DBusCall::runtimeZone("removeIcmpBlock", [=](auto *z) { return z->removeIcmpBlock(zone, "time-exceeded"); }),
+                DBusCall::configZone(zone, "removeIcmpBlockInversion", [](auto *z) { return z->removeIcmpBlockInversion(); }),
+                DBusCall::configZone(zone, "removeIcmpBlock", [](auto *z) { return z->removeIcmpBlock("destination-unreachable"); }),
+                DBusCall::configZone(zone, "removeIcmpBlock", [](auto *z) { return z->removeIcmpBlock("time-exceeded"); }),
+            }, done);
+        }
+    });
 }
 
 void FirewallBackend::addService(const QString &service, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) {
-        emit operationError("Could not find path for zone: " + zone);
+    if (m_batchActive) {
+        stageEdit(zone, "addService", service, [service](ZoneSettings &z) {
+            if (!z.services.contains(service)) z.services.append(service);
+        });
         return;
     }
 
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    
-    QDBusReply<void> reply = zoneIf.call("addService", service);
-    
-    if (!reply.isValid()) {
-        emit operationError("Failed to add service '" + service + "': " + reply.error().message());
-    } else {
-        reload();
-    }
+    applyBoth("Failed to add service '" + service + "'",
+              {DBusCall::runtimeZone("addService", [=](auto *z) { return z->addService(zone, service, 0); }),
+               DBusCall::configZone(zone, "addService", [=](auto *z) { return z->addService(service); })});
 }
 
 void FirewallBackend::removeService(const QString &service, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    zoneIf.call("removeService", service);
-    reload();
+    if (m_batchActive) {
+        stageEdit(zone, "removeService", service, [service](ZoneSettings &z) { z.services.removeAll(service); });
+        return;
+    }
+
+    applyBoth("Failed to remove service '" + service + "'",
+              {DBusCall::runtimeZone("removeService", [=](auto *z) { return z->removeService(zone, service); }),
+               DBusCall::configZone(zone, "removeService", [=](auto *z) { return z->removeService(service); })});
 }
 
 void FirewallBackend::addPort(const QString &port, const QString &protocol, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    QDBusReply<void> reply = zoneIf.call("addPort", port, protocol);
-
-    if (!reply.isValid()) {
-        emit operationError("Failed to add port: " + reply.error().message());
-    } else {
-        reload();
+    if (m_batchActive) {
+        const ZonePort entry{port, protocol};
+        stageEdit(zone, "addPort", port.isEmpty() ? QString() : port + "/" + protocol, [entry](ZoneSettings &z) {
+            if (!z.ports.contains(entry)) z.ports.append(entry);
+        });
+        return;
     }
+
+    applyBoth("Failed to add port",
+              {DBusCall::runtimeZone("addPort", [=](auto *z) { return z->addPort(zone, port, protocol, 0); }),
+               DBusCall::configZone(zone, "addPort", [=](auto *z) { return z->addPort(port, protocol); })});
 }
 
 void FirewallBackend::removePort(const QString &port, const QString &protocol, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    zoneIf.call("removePort", port, protocol);
-    reload();
+    if (m_batchActive) {
+        const ZonePort entry{port, protocol};
+        stageEdit(zone, "removePort", port + "/" + protocol, [entry](ZoneSettings &z) { z.ports.removeAll(entry); });
+        return;
+    }
+
+    applyBoth("Failed to remove port",
+              {DBusCall::runtimeZone("removePort", [=](auto *z) { return z->removePort(zone, port, protocol); }),
+               DBusCall::configZone(zone, "removePort", [=](auto *z) { return z->removePort(port, protocol); })});
 }
 
 void FirewallBackend::addForwardRule(const QString &src, const QString &proto, const QString &destPort, const QString &destIP, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) {
-        emit operationError("Could not find path for zone: " + zone);
+    if (m_batchActive) {
+        const ForwardPort entry{src, proto, destPort, destIP};
+        stageEdit(zone, "addForwardPort", src.isEmpty() ? QString() : src + "/" + proto + " -> " + destIP + ":" + destPort,
+                  [entry](ZoneSettings &z) {
+            if (!z.forwardPorts.contains(entry)) z.forwardPorts.append(entry);
+        });
         return;
     }
 
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    
-    QDBusReply<void> reply = zoneIf.call("addForwardPort", src, proto, destPort, destIP);
-    
-    if (!reply.isValid()) {
-        emit operationError("Failed to add forward rule: " + reply.error().message());
-    } else {
-        reload();
-    }
+    applyBoth("Failed to add forward rule",
+              {DBusCall::runtimeZone("addForwardPort", [=](auto *z) { return z->addForwardPort(zone, src, proto, destPort, destIP, 0); }),
+               DBusCall::configZone(zone, "addForwardPort", [=](auto *z) { return z->addForwardPort(src, proto, destPort, destIP); })});
 }
 
 void FirewallBackend::removeForwardRule(const QString &src, const QString &proto, const QString &destPort, const QString &destIP, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    zoneIf.call("removeForwardPort", src, proto, destPort, destIP);
-    reload();
+    if (m_batchActive) {
+        const ForwardPort entry{src, proto, destPort, destIP};
+        stageEdit(zone, "removeForwardPort", src + "/" + proto + " -> " + destIP + ":" + destPort,
+                  [entry](ZoneSettings &z) { z.forwardPorts.removeAll(entry); });
+        return;
+    }
+
+    applyBoth("Failed to remove forward rule",
+              {DBusCall::runtimeZone("removeForwardPort", [=](auto *z) { return z->removeForwardPort(zone, src, proto, destPort, destIP); }),
+               DBusCall::configZone(zone, "removeForwardPort", [=](auto *z) { return z->removeForwardPort(src, proto, destPort, destIP); })});
 }
 
 void FirewallBackend::changeDefaultZone(const QString &zone)
 {
-    QDBusInterface fw(FW_SERVICE, FW_PATH, FW_INTERFACE, QDBusConnection::systemBus());
-    fw.call("setDefaultZone", zone);
-    refresh(zone); 
+    // The view is not moved; DefaultZoneChanged updates defaultZone
+    m_bus->call(DBusCall::main("setDefaultZone", [zone](auto *fw) { return fw->setDefaultZone(zone); }),
+                [this, zone](const DBusResult &reply) {
+        if (reply.isError()) emit operationError("Failed to change default zone to '" + zone + "': " + reply.error.message());
+    });
 }
 
 void FirewallBackend::setMasquerade(bool enabled, const QString &zone)
 {
-    QString path = getPermanentZonePath(zone);
-    if (path.isEmpty()) return;
-    QDBusInterface zoneIf(FW_SERVICE, path, FW_CONFIG_ZONE_INTERFACE, QDBusConnection::systemBus());
-    if (enabled) zoneIf.call("addMasquerade");
-    else zoneIf.call("removeMasquerade");
-    reload();
+    if (m_batchActive) {
+        stageEdit(zone, "setMasquerade", enabled ? "on" : "off", [enabled](ZoneSettings &z) { z.masquerade = enabled; });
+        return;
+    }
+
+    patchZone(zone, [enabled](ZoneSettings &z) { return std::exchange(z.masquerade, enabled) != enabled; });
+
+    m_writes->schedule(zone, "masquerade", [this, zone, enabled](const WriteScheduler::Done &done) {
+        if (enabled) {
+            applyBoth("Failed to enable masquerading",
+                      {DBusCall::runtimeZone("addMasquerade", [zone](auto *z) { return z->addMasquerade(zone, 0); }),
+                       DBusCall::configZone(zone, "addMasquerade", [](auto *z) { return z->addMasquerade(); })}, done);
+        } else {
+            applyBoth("Failed to disable masquerading",
+                      {DBusCall::runtimeZone("removeMasquerade", [zone](auto *z) { return z->removeMasquerade(zone); }),
+                       DBusCall::configZone(zone, "removeMasquerade", [](auto *z) { return z->removeMasquerade(); })}, done);
+        }
+    });
 }
 
+// Switching on keeps a narrower setting (unicast, ...) that is already there
 void FirewallBackend::setLogDenied(bool enabled)
 {
-    QDBusInterface fw(FW_SERVICE, FW_PATH, FW_INTERFACE, QDBusConnection::systemBus());
-    QString value = enabled ? "all" : "off";
-    
-    fw.call("setLogDenied", value); 
-    
-    setLogDeniedState(enabled);
+    if (enabled == (m_snapshot.logDenied != "off")) return;
+    const QString value = enabled ? "all" : "off";
+    updateSnapshot([&value](Snapshot &s) { s.logDenied = value; });
+
+    m_writes->schedule(QString(), "logDenied", [this, value](const WriteScheduler::Done &done) {
+        m_bus->call(DBusCall::main("setLogDenied", [value](auto *fw) { return fw->setLogDenied(value); }),
+                    [this, done](const DBusResult &reply) {
+            if (reply.isError()) emit operationError("Failed to change denied-packet logging: " + reply.error.message());
+            done(!reply.isError());
+        });
+    });
+}
+
+// === BATCHES ===
+
+bool FirewallBackend::beginBatch()
+{
+    if (m_batchActive) return false;
+    m_batch.clear();
+    m_batchErrors.clear();
+    setBatchActive(true);
+    return true;
+}
+
+void FirewallBackend::abortBatch()
+{
+    m_batch.clear();
+    m_batchErrors.clear();
+    setBatchActive(false);
+}
+
+void FirewallBackend::stageEdit(const QString &zone, const QString &action, const QString &item,
+                                const std::function<void(ZoneSettings &)> &apply)
+{
+    const ConfigWriter::Edit edit{zone, action, item, apply};
+
+    // Nothing to send for these; they come back in the result instead
+    if (zone.isEmpty()) m_batchErrors.append(ConfigWriter::editError(edit, "No zone given"));
+    else if (item.isEmpty()) m_batchErrors.append(ConfigWriter::editError(edit, "Nothing to " + action));
+    else m_batch.append(edit);
+}
+
+bool FirewallBackend::commitBatch()
+{
+    if (!m_batchActive) return false;
+
+    const QList<ConfigWriter::Edit> edits = std::exchange(m_batch, {});
+    const QVariantList rejected = std::exchange(m_batchErrors, {});
+    setBatchActive(false);
+
+    m_writer->commit(edits, rejected, [this](const QVariantMap &result) { emit batchFinished(result); });
+    return true;
+}
+
+// === POLICY FILES ===
+
+// Permanent config only: no queued toggles, no startup cache
+QString FirewallBackend::exportPolicy() const
+{
+    if (m_showingCache) return QString();
+    return QString::fromUtf8(Policy::toJson(m_snapshot.defaultZone, m_snapshot.logDenied, m_snapshot.panic, m_zoneSettings));
+}
+
+bool FirewallBackend::savePolicy(const QUrl &file)
+{
+    const QString policy = exportPolicy();
+    if (policy.isEmpty()) {
+        emit operationError("Failed to save policy: firewalld has not been read yet");
+        return false;
+    }
+
+    QSaveFile out(file.isLocalFile() ? file.toLocalFile() : file.toString());
+    if (!out.open(QIODevice::WriteOnly) || out.write(policy.toUtf8()) < 0 || !out.commit()) {
+        emit operationError("Failed to save policy: " + out.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool FirewallBackend::exportTrace(const QUrl &file)
+{
+    const QString path = file.isLocalFile() ? file.toLocalFile() : file.toString();
+    if (!m_bus->trace()->writeChromeTrace(path)) {
+        emit operationError("Failed to write trace to " + path);
+        return false;
+    }
+    return true;
+}
+
+bool FirewallBackend::loadPolicy(const QUrl &file)
+{
+    QFile in(file.isLocalFile() ? file.toLocalFile() : file.toString());
+    if (!in.open(QIODevice::ReadOnly)) {
+        emit operationError("Failed to read policy: " + in.errorString());
+        return false;
+    }
+    return applyPolicy(QString::fromUtf8(in.readAll()));
+}
+
+bool FirewallBackend::applyPolicy(const QString &json)
+{
+    Policy policy;
+    QString error;
+    if (!Policy::fromJson(json.toUtf8(), policy, error)) {
+        emit operationError("Invalid policy: " + error);
+        return false;
+    }
+
+    if (m_policyPending || !m_bus->isConnected()) return false;
+
+    // The view follows through the change signals once firewalld has it
+    m_policyPending = true;
+    m_writer->applyPolicy(policy, [this](const QVariantMap &result) {
+        m_policyPending = false;
+        emit policyApplied(result);
+    });
+    return true;
+}
+
+// === BULK SOURCE IMPORT ===
+// Big lists go into an ipset bound as one "ipset:" source; one reload at the end
+
+struct FirewallBackend::ImportUpload {
+    QString zone;
+    int pending = 0;
+    QStringList ipsets;     // uploaded and bound
+    qsizetype entries = 0;  // after aggregation
+    qsizetype toUpload = 0; // new to the sets, both families
+    qsizetype uploaded = 0;
+    QStringList errors;
+    QVariantMap stats;
+};
+
+bool FirewallBackend::importSources(const QUrl &file, const QString &ipset, const QString &zone)
+{
+    // firewalld caps ipset names at 32 characters; keep room for "-v6"
+    static const QRegularExpression validName("^[A-Za-z0-9_.-]{1,29}$");
+    if (m_import || zone.isEmpty() || !validName.match(ipset).hasMatch()) return false;
+
+    qDBusRegisterMetaType<IPSetSettings>();
+
+    m_import = new SourceImport(file.isLocalFile() ? file.toLocalFile() : file.toString(), this);
+    setImporting(true);
+
+    connect(m_import, &SourceImport::progress, this, [this](const QVariantMap &stats) {
+        QVariantMap progress = stats;
+        progress.insert("stage", "reading");
+        emit importProgress(progress);
+    });
+    connect(m_import, &SourceImport::finished, this, [this, ipset, zone](bool ok, const QString &error) {
+        if (!ok) finishImport(false, error);
+        else uploadImport(ipset, zone);
+    });
+
+    m_import->start();
+    return true;
+}
+
+void FirewallBackend::uploadImport(const QString &ipset, const QString &zone)
+{
+    auto upload = QSharedPointer<ImportUpload>::create();
+    upload->zone = zone;
+    upload->stats = m_import->stats();
+
+    const PrefixTrie &v4 = m_import->ipv4();
+    const PrefixTrie &v6 = m_import->ipv6();
+    if (v4.isEmpty() && v6.isEmpty()) {
+        finishImport(false, tr("No addresses found"), upload->stats);
+        return;
+    }
+
+    QVariantMap progress = upload->stats;
+    progress.insert("stage", "uploading");
+    progress.insert("uploaded", 0);
+    progress.insert("toUpload", 0);
+    emit importProgress(progress);
+
+    upload->pending = int(!v4.isEmpty()) + int(!v6.isEmpty());
+    if (!v4.isEmpty()) uploadIPSet(upload, ipset, v4);
+    if (!v6.isEmpty()) uploadIPSet(upload, ipset + "-v6", v6);
+}
+
+void FirewallBackend::uploadIPSet(const QSharedPointer<ImportUpload> &upload, const QString &name, const PrefixTrie &trie)
+{
+    // The trie belongs to m_import, which outlives the upload
+    const PrefixTrie *source = &trie;
+    const auto lookup = [name](auto *config) { return config->getIPSetByName(name); };
+    m_bus->call(DBusCall::config("getIPSetByName", lookup), [this, upload, name, source](const DBusResult &reply) {
+        if (!reply.isError()) {
+            extendIPSet(upload, name, reply.arguments.value(0).value<QDBusObjectPath>().path(), source);
+            return;
+        }
+        if (!reply.error.message().startsWith("INVALID_IPSET")) {
+            upload->errors.append(name + ": " + reply.error.message());
+            finishIPSet(upload);
+            return;
+        }
+
+        // New set: created empty, then filled like an existing one
+        const QStringList entries = source->toStrings();
+
+        IPSetSettings settings;
+        settings.shortName = name;
+        settings.description = tr("Imported by Cinderward");
+        settings.type = "hash:net";
+        settings.options.insert("family", source->family() == PrefixTrie::IPv4 ? "inet" : "inet6");
+        settings.options.insert("maxelem", QString::number(qMax<qsizetype>(65536, entries.size())));
+
+        m_bus->call(DBusCall::config("addIPSet", [name, settings](auto *config) { return config->addIPSet(name, settings); }),
+                    [this, upload, name, entries](const DBusResult &reply) {
+            if (reply.isError()) {
+                upload->errors.append(name + ": " + reply.error.message());
+                finishIPSet(upload);
+                return;
+            }
+            const QString path = reply.arguments.value(0).value<QDBusObjectPath>().path();
+            upload->entries += entries.size();
+            upload->toUpload += entries.size();
+            uploadIPSetEntries(upload, name, path, {}, entries, 0);
+        });
+    });
+}
+
+// Existing set: nothing is sent unless it can take the entries
+void FirewallBackend::extendIPSet(const QSharedPointer<ImportUpload> &upload, const QString &name, const QString &path,
+                                  const PrefixTrie *source)
+{
+    DBusCall call = DBusCall::configIPSet(path, "getSettings", [](auto *ipset) { return ipset->getSettings(); });
+    call.decode = [](const QDBusMessage &reply) {
+        return QVariant::fromValue(qdbus_cast<IPSetSettings>(reply.arguments().value(0)));
+    };
+
+    m_bus->call(call, [this, upload, name, path, source](const DBusResult &reply) {
+        const auto fail = [this, upload, name](const QString &message) {
+            upload->errors.append(name + ": " + message);
+            finishIPSet(upload);
+        };
+        if (reply.isError()) {
+            fail(reply.error.message());
+            return;
+        }
+
+        const IPSetSettings settings = reply.value.value<IPSetSettings>();
+        const QStringList wanted = source->toStrings();
+
+        // 1. hash:net takes networks; hash:ip only plain addresses
+        const bool hostsOnly = std::none_of(wanted.cbegin(), wanted.cend(), [](const QString &entry) {
+            return entry.contains('/');
+        });
+        if (settings.type != "hash:net" && !(settings.type == "hash:ip" && hostsOnly)) {
+            fail(tr("existing set is %1, which can't hold these entries").arg(settings.type));
+            return;
+        }
+
+        // 2. Same family
+        const QString family = source->family() == PrefixTrie::IPv4 ? "inet" : "inet6";
+        if (settings.options.value("family", "inet") != family) {
+            fail(tr("existing set is for %1, not %2").arg(settings.options.value("family", "inet"), family));
+            return;
+        }
+
+        // 3. Only what it lacks, with room made for it
+        const QSet<QString> present(settings.entries.cbegin(), settings.entries.cend());
+        QStringList added;
+        for (const QString &entry : wanted) {
+            if (!present.contains(entry)) added.append(entry);
+        }
+        const qsizetype total = settings.entries.size() + added.size();
+        upload->entries += total;
+        upload->toUpload += added.size();
+
+        if (added.isEmpty()) {
+            bindIPSet(upload, name);
+            return;
+        }
+        if (total <= settings.options.value("maxelem", "65536").toLongLong()) {
+            uploadIPSetEntries(upload, name, path, settings.entries, added, 0);
+            return;
+        }
+
+        const auto raise = [total](auto *ipset) { return ipset->addOption("maxelem", QString::number(total)); };
+        m_bus->call(DBusCall::configIPSet(path, "addOption", raise),
+                    [this, upload, name, path, existing = settings.entries, added, fail](const DBusResult &reply) {
+            if (reply.isError() && !isBenignFirewallError(reply.error)) {
+                fail(tr("could not raise maxelem: %1").arg(reply.error.message()));
+                return;
+            }
+            uploadIPSetEntries(upload, name, path, existing, added, 0);
+        });
+    });
+}
+
+// config.ipset has no addEntries, and addEntry rewrites the set's file for every
+// entry, so each setEntries grows the set by IPSET_ENTRY_CHUNK
+void FirewallBackend::uploadIPSetEntries(const QSharedPointer<ImportUpload> &upload, const QString &name, const QString &path,
+                                         const QStringList &existing, const QStringList &added, qsizetype from)
+{
+    if (from >= added.size()) {
+        bindIPSet(upload, name);
+        return;
+    }
+
+    const qsizetype to = qMin(added.size(), from + IPSET_ENTRY_CHUNK);
+    const QStringList entries = existing + added.first(to);
+    m_bus->call(DBusCall::configIPSet(path, "setEntries", [entries](auto *ipset) { return ipset->setEntries(entries); }),
+                [this, upload, name, path, existing, added, from, to](const DBusResult &reply) {
+        if (reply.isError()) {
+            upload->errors.append(tr("%1: %2 (%3 of %4 new entries were added)")
+                                      .arg(name, reply.error.message()).arg(from).arg(added.size()));
+            finishIPSet(upload);
+            return;
+        }
+
+        upload->uploaded += to - from;
+        QVariantMap progress = upload->stats;
+        progress.insert("stage", "uploading");
+        progress.insert("uploaded", upload->uploaded);
+        progress.insert("toUpload", upload->toUpload);
+        emit importProgress(progress);
+
+        uploadIPSetEntries(upload, name, path, existing, added, to);
+    });
+}
+
+void FirewallBackend::bindIPSet(const QSharedPointer<ImportUpload> &upload, const QString &name)
+{
+    // The runtime can't see the set until the reload, so only the permanent zone is told
+    const QString source = "ipset:" + name;
+    m_bus->call(DBusCall::configZone(upload->zone, "addSource", [source](auto *z) { return z->addSource(source); }),
+                [this, upload, name](const DBusResult &reply) {
+        if (reply.isError() && !isBenignFirewallError(reply.error)) upload->errors.append(name + ": " + reply.error.message());
+        else upload->ipsets.append(name);
+        finishIPSet(upload);
+    });
+}
+
+void FirewallBackend::finishIPSet(const QSharedPointer<ImportUpload> &upload)
+{
+    if (--upload->pending > 0) return;
+
+    QVariantMap extra = upload->stats;
+    extra.insert("ipsets", upload->ipsets);
+    extra.insert("entries", upload->entries);
+    extra.insert("errors", upload->errors);
+
+    if (upload->ipsets.isEmpty()) {
+        finishImport(false, upload->errors.join('\n'), extra);
+        return;
+    }
+
+    QVariantMap progress = extra;
+    progress.insert("stage", "reloading");
+    emit importProgress(progress);
+
+    m_bus->call(DBusCall::main("reload", [](auto *fw) { return fw->reload(); }), [this, upload, extra](const DBusResult &reply) {
+        if (reply.isError()) upload->errors.append("reload: " + reply.error.message());
+
+        QVariantMap result = extra;
+        result.insert("errors", upload->errors);
+        finishImport(upload->errors.isEmpty(), upload->errors.join('\n'), result);
+    });
+}
+
+void FirewallBackend::finishImport(bool ok, const QString &message, const QVariantMap &extra)
+{
+    QVariantMap result = extra;
+    if (result.isEmpty() && m_import) result = m_import->stats();
+    result.insert("ok", ok);
+    result.insert("message", message);
+
+    m_import->deleteLater();
+    m_import = nullptr;
+    setImporting(false);
+    emit importFinished(result);
 }
 
 // === GLOBAL ACTIONS ===
 
+// Reloaded re-syncs the view once firewalld is done.
 void FirewallBackend::reload()
 {
-    QDBusInterface fw(FW_SERVICE, FW_PATH, FW_INTERFACE, QDBusConnection::systemBus());
-    fw.call("reload");
-    refresh(m_defaultZone); 
+    m_bus->call(DBusCall::main("reload", [](auto *fw) { return fw->reload(); }));
 }
 
+// Shown at once; PanicModeEnabled / PanicModeDisabled confirm it.
 void FirewallBackend::setPanic(bool enabled)
 {
-    QDBusInterface fw(FW_SERVICE, FW_PATH, FW_INTERFACE, QDBusConnection::systemBus());
-    if (enabled)
-        fw.call("enablePanicMode");
-    else
-        fw.call("disablePanicMode");
-    
-    refresh(m_defaultZone);
+    updateSnapshot([enabled](Snapshot &s) { s.panic = enabled; });
+
+    m_writes->schedule(QString(), "panic", [this, enabled](const WriteScheduler::Done &done) {
+        const DBusCall call = enabled ? DBusCall::main("enablePanicMode", [](auto *fw) { return fw->enablePanicMode(); })
+                                      : DBusCall::main("disablePanicMode", [](auto *fw) { return fw->disablePanicMode(); });
+        m_bus->call(call, [this, done](const DBusResult &reply) {
+            if (reply.isError() && !isBenignFirewallError(reply.error))
+                emit operationError("Failed to change panic mode: " + reply.error.message());
+            done(!reply.isError() || isBenignFirewallError(reply.error));
+        });
+    });
 }
@@ -3,41 +3,85 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
-#include <QDBusInterface>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <QUrl>
+
+#include "callstatsmodel.h"
+#include "configwriter.h"
+#include "deniedlogmodel.h"
+#include "firewallworker.h"
+#include "portindex.h"
+#include "rulelistmodel.h"
+#include "servicecatalog.h"
+#include "writescheduler.h"
+#include "zonesettings.h"
+
+#include <functional>
+
+class FirewallConnection;
+class SocketInventory;
+class SourceImport;
+class PrefixTrie;
 
 class FirewallBackend : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QString state READ state NOTIFY stateChanged)
     Q_PROPERTY(QString defaultZone READ defaultZone NOTIFY defaultZoneChanged)
+    Q_PROPERTY(QString currentZone READ currentZone NOTIFY currentZoneChanged)
+    Q_PROPERTY(QStringList zones READ zones NOTIFY zonesChanged)
     Q_PROPERTY(QStringList services READ services NOTIFY servicesChanged)
     Q_PROPERTY(QStringList ports READ ports NOTIFY portsChanged)
     Q_PROPERTY(QStringList sources READ sources NOTIFY sourcesChanged)
     Q_PROPERTY(QStringList forwardRules READ forwardRules NOTIFY forwardRulesChanged)
+    Q_PROPERTY(RuleListModel *rules READ rules CONSTANT)
     Q_PROPERTY(bool masquerade READ masquerade NOTIFY masqueradeChanged)
     Q_PROPERTY(bool logDenied READ logDenied NOTIFY logDeniedChanged)
     Q_PROPERTY(bool panic READ panic NOTIFY panicChanged)
     Q_PROPERTY(QStringList knownServices READ knownServices NOTIFY knownServicesChanged)
+    Q_PROPERTY(ServiceCatalog *serviceCatalog READ serviceCatalog CONSTANT)
+    Q_PROPERTY(CallStatsModel *callStats READ callStats CONSTANT)
+    Q_PROPERTY(DeniedLogModel *deniedLog READ deniedLog CONSTANT)
     Q_PROPERTY(bool stealthMode READ stealthMode NOTIFY stealthModeChanged)
     Q_PROPERTY(bool strictIcmp READ strictIcmp NOTIFY strictIcmpChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+    Q_PROPERTY(bool batchActive READ batchActive NOTIFY batchActiveChanged)
+    Q_PROPERTY(bool importing READ importing NOTIFY importingChanged)
+    // Bumped whenever any zone's settings change; bind to it to re-run explainPort() etc.
+    Q_PROPERTY(int configRevision READ configRevision NOTIFY configRevisionChanged)
 
 public:
     explicit FirewallBackend(QObject *parent = nullptr);
+    // Talks to firewalld over `bus` instead of the system bus; takes ownership
+    explicit FirewallBackend(FirewallConnection *bus, QObject *parent = nullptr);
 
     QString state() const;
     QString defaultZone() const;
+    QString currentZone() const;
+    QStringList zones() const;
     QStringList services() const;
     QStringList ports() const;
     QStringList sources() const;
     QStringList forwardRules() const;
+    RuleListModel *rules() const;
     QStringList knownServices() const;
+    ServiceCatalog *serviceCatalog() const;
+    CallStatsModel *callStats() const;
+    DeniedLogModel *deniedLog() const;
     bool masquerade() const;
     bool logDenied() const;
     bool panic() const;
     bool stealthMode() const;
     bool strictIcmp() const;
+    bool busy() const;
+    bool batchActive() const;
+    bool importing() const;
+    int configRevision() const;
 
     Q_INVOKABLE void refresh(const QString &zone);
+    Q_INVOKABLE void viewZone(const QString &zone);
     Q_INVOKABLE void addService(const QString &service, const QString &zone);
     Q_INVOKABLE void removeService(const QString &service, const QString &zone);
     Q_INVOKABLE void addPort(const QString &port, const QString &protocol, const QString &zone);
@@ -54,9 +98,37 @@ public:
     Q_INVOKABLE void setStealthMode(bool enabled, const QString &zone);
     Q_INVOKABLE void setStrictIcmp(bool enabled, const QString &zone);
 
+    // Zone edits are staged while a batch is open; global switches never are
+    Q_INVOKABLE bool beginBatch();
+    Q_INVOKABLE bool commitBatch();
+    Q_INVOKABLE void abortBatch();
+
+    // Adds a list of IPs / CIDRs to the ipset `ipset` (`ipset`-v6 for IPv6) and
+    // binds it to the zone. Not staged by batches.
+    Q_INVOKABLE bool importSources(const QUrl &file, const QString &ipset, const QString &zone);
+
+    // What already opens a port or range ("8080", "1000-2000"), across all zones:
+    // [{zone, kind: port|service|forward, item, protocol, first, last}]
+    Q_INVOKABLE QVariantList explainPort(const QString &port, const QString &protocol);
+    // Explicit ports of the zone already opened by another of its entries, each
+    // with a coveredBy entry in the same shape
+    Q_INVOKABLE QVariantList redundantPorts(const QString &zone);
+
+    // Declarative policy, see policy.h. exportPolicy() is empty until firewalld
+    // has been read; applyPolicy() sends only what differs.
+    Q_INVOKABLE QString exportPolicy() const;
+    Q_INVOKABLE bool applyPolicy(const QString &json);
+    Q_INVOKABLE bool savePolicy(const QUrl &file);
+    Q_INVOKABLE bool loadPolicy(const QUrl &file);
+
+    // The last firewalld calls as Chrome trace-event JSON (chrome://tracing, Perfetto)
+    Q_INVOKABLE bool exportTrace(const QUrl &file);
+
 signals:
     void stateChanged();
     void defaultZoneChanged();
+    void currentZoneChanged();
+    void zonesChanged();
     void servicesChanged();
     void operationOutput(const QString &output);
     void operationError(const QString &error);
@@ -69,32 +141,127 @@ signals:
     void knownServicesChanged();
     void stealthModeChanged();
     void strictIcmpChanged();
+    void busyChanged();
+    void batchActiveChanged();
+    void batchFinished(const QVariantMap &result);
+    void importingChanged();
+    void importProgress(const QVariantMap &progress);
+    void importFinished(const QVariantMap &result);
+    void configRevisionChanged();
+    void policyApplied(const QVariantMap &result);
 
 private:
-    QString getPermanentZonePath(const QString &zoneName);
+    // Everything refresh() collects before any property is touched.
+    struct Snapshot {
+        QString defaultZone;
+        QString zoneName;
+        bool panic = false;
+        QString logDenied = QStringLiteral("off");
+        bool zoneFound = false;
+        ZoneSettings zone;
+    };
+
+    struct ImportUpload;
+
+    void finishRefresh(const QString &zone, const FirewallStatePtr &state);
+    void syncZone(const QString &zoneName);
+    void storeZone(const QString &zone, bool found, const ZoneSettings &settings);
+    void showZone(const QString &zone);
+    ZoneSettings zoneView(const QString &zone) const;
+    void applySnapshot(const Snapshot &snapshot);
+    void updateSnapshot(const std::function<void(Snapshot &)> &change);
+    void patchZone(const QString &zone, const std::function<bool(ZoneSettings &)> &patch);
+    void connectChangeSignals();
+    void markZonesChanged();
+    const PortIndex &portIndex();
+    void updateListeners();
+    void loadCache();
+    void saveCache();
+    void checkFirewalldVersion();
+    void loadKnownServices();
+    void applyBoth(const QString &failure, const QList<DBusCall> &calls,
+                   const WriteScheduler::Done &done = {});
+
+    void stageEdit(const QString &zone, const QString &action, const QString &item,
+                   const std::function<void(ZoneSettings &)> &apply);
+
+    void uploadImport(const QString &ipset, const QString &zone);
+    void uploadIPSet(const QSharedPointer<ImportUpload> &upload, const QString &name, const PrefixTrie &trie);
+    void extendIPSet(const QSharedPointer<ImportUpload> &upload, const QString &name, const QString &path,
+                     const PrefixTrie *source);
+    void uploadIPSetEntries(const QSharedPointer<ImportUpload> &upload, const QString &name, const QString &path,
+                            const QStringList &existing, const QStringList &added, qsizetype from);
+    void bindIPSet(const QSharedPointer<ImportUpload> &upload, const QString &name);
+    void finishIPSet(const QSharedPointer<ImportUpload> &upload);
+    void finishImport(bool ok, const QString &message, const QVariantMap &extra = {});
 
     void setState(const QString &s);
     void setDefaultZone(const QString &z);
+    void setCurrentZone(const QString &z);
+    void setZones(const QStringList &z);
     void setServices(const QStringList &s);
     void setPanicState(bool enabled);
     void setPorts(const QStringList &p);
     void setSources(const QStringList &s);
+    void setKnownServices(const QStringList &s);
     void setForwardRules(const QStringList &r);
     void setMasqueradeState(bool enabled);
     void setLogDeniedState(bool enabled);
     void setStealthModeState(bool enabled);
     void setStrictIcmpState(bool enabled);
+    void setBusy(bool busy);
+    void setBatchActive(bool active);
+    void setImporting(bool importing);
 
     QString m_state;
     QString m_defaultZone;
+    QString m_currentZone;
+    QStringList m_zones;
     QStringList m_services;
     QStringList m_ports;
     QStringList m_sources;
     QStringList m_forwardRules;
     QStringList m_knownServices;
+    RuleListModel *m_rules = nullptr;
+    ServiceCatalog *m_catalog = nullptr;
+    CallStatsModel *m_callStats = nullptr;
+    DeniedLogModel *m_deniedLog = nullptr;
+    SocketInventory *m_sockets = nullptr;
     bool m_panic = false;
     bool m_masquerade = false;
     bool m_logDenied = false;
     bool m_stealthMode = false;
     bool m_strictIcmp = false;
+    bool m_busy = false;
+    Snapshot m_snapshot; // last applied; zone is zoneView(zoneName)
+    quint64 m_refreshGeneration = 0;
+    QSet<QString> m_resyncZones; // waiting for the in-flight refresh
+
+    QHash<QString, ZoneSettings> m_zoneSettings; // every zone's permanent config, only ever read from firewalld
+    QHash<QString, ZoneSettings> m_pendingZones; // shown instead while our own toggles are queued
+    QHash<QString, quint64> m_zoneReads;         // newest single-zone read per zone
+    quint64 m_zoneReadGeneration = 0;
+
+    PortIndex m_portIndex; // over m_zoneSettings, rebuilt lazily
+    bool m_portIndexDirty = true;
+    int m_configRevision = 0;
+
+    bool m_showingCache = false; // nothing live has replaced the startup cache yet
+    QString m_cachedVersion;
+    QString m_firewalldVersion;
+
+    WriteScheduler *m_writes = nullptr;
+    ConfigWriter *m_writer = nullptr; // batches and policy files
+    QSet<QString> m_resyncAfterWrites;
+
+    bool m_batchActive = false;
+    QList<ConfigWriter::Edit> m_batch;
+    QVariantList m_batchErrors;
+
+    bool m_policyPending = false;
+
+    SourceImport *m_import = nullptr;
+    bool m_importing = false;
+
+    FirewallConnection *m_bus = nullptr; // the worker thread that does all the bus I/O
 };
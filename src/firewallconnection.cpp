@@ -0,0 +1,126 @@
+#include "firewallconnection.h"
+
+#include <QAtomicInteger>
+#include <QDebug>
+#include <QThread>
+
+#include <utility>
+
+FirewallConnection::FirewallConnection(QDBusConnection::BusType bus, QObject *parent)
+    : FirewallConnection(bus, QString(), parent)
+{
+}
+
+FirewallConnection::FirewallConnection(const QString &address, QObject *parent)
+    : FirewallConnection(QDBusConnection::SessionBus, address, parent)
+{
+}
+
+FirewallConnection::FirewallConnection(QDBusConnection::BusType bus, const QString &address, QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<DBusResult>();
+    qRegisterMetaType<FirewallStatePtr>();
+
+    // Each instance gets a connection of its own; the shared systemBus() stays untouched
+    static QAtomicInteger<int> instances;
+    const QString name = QStringLiteral("cinderward-worker-%1").arg(instances.fetchAndAddRelaxed(1));
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName(name);
+    m_trace = std::make_unique<CallTrace>();
+    m_worker = new FirewallWorker(bus, address, name, m_trace.get());
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    connect(m_worker, &FirewallWorker::finished, this, &FirewallConnection::onFinished);
+    connect(m_worker, &FirewallWorker::opened, this, [this](bool connected) {
+        m_connected = connected;
+        emit opened(connected);
+        flush();
+    });
+
+    connect(m_worker, &FirewallWorker::zonesChanged, this, &FirewallConnection::zonesChanged);
+    connect(m_worker, &FirewallWorker::zoneUpdated, this, &FirewallConnection::zoneUpdated);
+    connect(m_worker, &FirewallWorker::runtimeChanged, this, &FirewallConnection::runtimeChanged);
+    connect(m_worker, &FirewallWorker::defaultZoneChanged, this, &FirewallConnection::defaultZoneChanged);
+    connect(m_worker, &FirewallWorker::panicChanged, this, &FirewallConnection::panicChanged);
+    connect(m_worker, &FirewallWorker::logDeniedChanged, this, &FirewallConnection::logDeniedChanged);
+
+    // Posted before any command, so the connection is up by the first drain
+    m_thread->start();
+    QMetaObject::invokeMethod(m_worker, &FirewallWorker::open, Qt::QueuedConnection);
+}
+
+FirewallConnection::~FirewallConnection()
+{
+    // The worker is deleted on its own thread as it winds down
+    m_thread->quit();
+    m_thread->wait();
+
+    // Set by --trace-file too, see main.cpp
+    const QString traceFile = qEnvironmentVariable("CINDERWARD_TRACE_FILE");
+    if (!traceFile.isEmpty() && !m_trace->writeChromeTrace(traceFile))
+        qWarning() << "Could not write the D-Bus trace to" << traceFile;
+}
+
+bool FirewallConnection::isConnected() const
+{
+    return m_connected;
+}
+
+const CallTrace *FirewallConnection::trace() const
+{
+    return m_trace.get();
+}
+
+void FirewallConnection::call(const DBusCall &call, const Handler &done)
+{
+    FirewallWorker::Command command;
+    command.kind = FirewallWorker::Call;
+    command.call = call;
+    submit(std::move(command), done);
+}
+
+void FirewallConnection::readZone(const QString &zone, const ZoneReader &done)
+{
+    FirewallWorker::Command command;
+    command.kind = FirewallWorker::ReadZone;
+    command.zone = zone;
+    submit(std::move(command), [done](const DBusResult &result) {
+        done(!result.isError(), result.value.value<ZoneSettings>());
+    });
+}
+
+void FirewallConnection::readState(const StateReader &done)
+{
+    FirewallWorker::Command command;
+    command.kind = FirewallWorker::ReadState;
+    submit(std::move(command), [done](const DBusResult &result) {
+        done(result.isError() ? FirewallStatePtr() : result.value.value<FirewallStatePtr>());
+    });
+}
+
+void FirewallConnection::submit(FirewallWorker::Command &&command, const Handler &done)
+{
+    command.id = ++m_nextId;
+    if (done) m_handlers.insert(command.id, done);
+
+    if (m_backlog.isEmpty() && m_worker->submit(std::move(command))) return;
+    m_backlog.append(std::move(command));
+}
+
+void FirewallConnection::flush()
+{
+    // Stops at the first refusal, so commands still reach the worker in order
+    while (!m_backlog.isEmpty() && m_worker->submit(std::move(m_backlog.first()))) m_backlog.removeFirst();
+}
+
+void FirewallConnection::onFinished(quint64 id, const DBusResult &result)
+{
+    const Handler handler = m_handlers.take(id);
+    if (handler) handler(result);
+
+    // The worker has made room
+    if (!m_backlog.isEmpty()) flush();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QDBusConnection>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+#include <memory>
+
+#include "calltrace.h"
+#include "firewallworker.h"
+
+class QThread;
+
+// GUI-side end of FirewallWorker. Nothing blocks; replies come back in order on this thread.
+class FirewallConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Handler = std::function<void(const DBusResult &result)>;
+    using ZoneReader = std::function<void(bool found, const ZoneSettings &settings)>;
+    using StateReader = std::function<void(const FirewallStatePtr &state)>; // null when unreachable
+
+    explicit FirewallConnection(QDBusConnection::BusType bus = QDBusConnection::SystemBus, QObject *parent = nullptr);
+    // A private bus by address, e.g. a test dbus-daemon running a stand-in firewalld
+    explicit FirewallConnection(const QString &address, QObject *parent = nullptr);
+    ~FirewallConnection() override;
+
+    void call(const DBusCall &call, const Handler &done = {});
+    void readZone(const QString &zone, const ZoneReader &done);
+    void readState(const StateReader &done);
+
+    // True until the worker has found otherwise; commands sent meanwhile wait for it
+    bool isConnected() const;
+
+    // Every call made so far, for diagnostics; safe to read at any time
+    const CallTrace *trace() const;
+
+signals:
+    void opened(bool connected);
+
+    // Forwarded from the worker, see FirewallWorker
+    void zonesChanged();
+    void zoneUpdated(const QString &zone);
+    void runtimeChanged(const QString &zone);
+    void defaultZoneChanged(const QString &zone);
+    void panicChanged(bool enabled);
+    void logDeniedChanged(const QString &value);
+
+private:
+    FirewallConnection(QDBusConnection::BusType bus, const QString &address, QObject *parent);
+
+    void submit(FirewallWorker::Command &&command, const Handler &done);
+    void flush();
+    void onFinished(quint64 id, const DBusResult &result);
+
+    std::unique_ptr<CallTrace> m_trace; // written by the worker, so it outlives it
+    QThread *m_thread = nullptr;
+    FirewallWorker *m_worker = nullptr;
+    bool m_connected = true;
+
+    QList<FirewallWorker::Command> m_backlog; // didn't fit the queue; goes before anything newer
+    QHash<quint64, Handler> m_handlers;       // by command id
+    quint64 m_nextId = 0;
+};
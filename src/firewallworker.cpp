@@ -0,0 +1,448 @@
+#include "firewallworker.h"
+#include "calltrace.h"
+#include "firewalld_interface.h"
+#include "firewalld_zone_interface.h"
+#include "firewalld_config_interface.h"
+#include "firewalld_config_zone_interface.h"
+#include "firewalld_config_ipset_interface.h"
+#include "dbus_properties_interface.h"
+#include <QDBusArgument>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+
+#include <utility>
+
+// Constants for Firewalld D-Bus
+
+const QString FW_SERVICE = "org.fedoraproject.FirewallD1";
+const QString FW_PATH = "/org/fedoraproject/FirewallD1";
+const QString FW_INTERFACE = "org.fedoraproject.FirewallD1";
+const QString FW_ZONE_INTERFACE = "org.fedoraproject.FirewallD1.zone";
+
+// Permanent Config Constants
+
+const QString FW_CONFIG_PATH = "/org/fedoraproject/FirewallD1/config";
+const QString FW_CONFIG_INTERFACE = "org.fedoraproject.FirewallD1.config";
+const QString FW_CONFIG_ZONE_INTERFACE = "org.fedoraproject.FirewallD1.config.zone";
+
+// === CALL DESCRIPTIONS ===
+
+template <typename Proxy>
+static DBusCall describe(DBusCall::Target target, const QString &method, const QString &object,
+                         const DBusCall::Call<Proxy> &invoke)
+{
+    DBusCall call;
+    call.target = target;
+    call.method = method;
+    call.object = object;
+    call.invoke = [invoke](QDBusAbstractInterface *proxy) { return invoke(static_cast<Proxy *>(proxy)); };
+    return call;
+}
+
+DBusCall DBusCall::main(const QString &method, const Call<FirewallDInterface> &invoke)
+{
+    return describe(Main, method, QString(), invoke);
+}
+
+DBusCall DBusCall::runtimeZone(const QString &method, const Call<FirewallDZoneInterface> &invoke)
+{
+    return describe(RuntimeZone, method, QString(), invoke);
+}
+
+DBusCall DBusCall::config(const QString &method, const Call<FirewallDConfigInterface> &invoke)
+{
+    return describe(Config, method, QString(), invoke);
+}
+
+DBusCall DBusCall::configZone(const QString &zone, const QString &method, const Call<FirewallDConfigZoneInterface> &invoke)
+{
+    return describe(ConfigZone, method, zone, invoke);
+}
+
+DBusCall DBusCall::configIPSet(const QString &path, const QString &method, const Call<FirewallDConfigIPSetInterface> &invoke)
+{
+    return describe(ConfigIPSet, method, path, invoke);
+}
+
+// Properties.Get; the generated property accessors block
+DBusCall DBusCall::mainProperty(const QString &name)
+{
+    return describe<DBusPropertiesInterface>(Properties, "Get", QString(), [name](DBusPropertiesInterface *properties) {
+        return properties->Get(FW_INTERFACE, name);
+    });
+}
+
+bool isBenignFirewallError(const QDBusError &error)
+{
+    const QString msg = error.message();
+    return msg.startsWith("ALREADY_ENABLED") || msg.startsWith("NOT_ENABLED");
+}
+
+// === THREAD HANDOVER ===
+
+FirewallWorker::FirewallWorker(QDBusConnection::BusType bus, const QString &address, const QString &connectionName,
+                               CallTrace *trace)
+    : m_trace(trace)
+    , m_busType(bus)
+    , m_busAddress(address)
+    , m_connectionName(connectionName)
+    , m_bus(connectionName)
+{
+}
+
+FirewallWorker::~FirewallWorker()
+{
+    // Proxies and watchers go first; they hold on to the connection
+    qDeleteAll(children());
+    QDBusConnection::disconnectFromBus(m_connectionName);
+}
+
+bool FirewallWorker::submit(Command &&command)
+{
+    if (!m_queue.push(std::move(command))) return false;
+
+    // One posted drain covers everything pushed until it starts
+    if (!m_wakePending.exchange(true, std::memory_order_acq_rel))
+        QMetaObject::invokeMethod(this, &FirewallWorker::drain, Qt::QueuedConnection);
+    return true;
+}
+
+void FirewallWorker::drain()
+{
+    // Cleared before popping: a push after this point posts a new drain
+    m_wakePending.exchange(false, std::memory_order_acq_rel);
+
+    Command command;
+    while (m_queue.pop(command)) execute(command);
+}
+
+void FirewallWorker::open()
+{
+    registerZoneSettingsTypes();
+
+    // Connecting, the bus hello and the proxies' name-owner lookups all block
+    m_bus = m_busAddress.isEmpty() ? QDBusConnection::connectToBus(m_busType, m_connectionName)
+                                   : QDBusConnection::connectToBus(m_busAddress, m_connectionName);
+    m_connected = m_bus.isConnected();
+
+    if (m_connected) {
+        m_fw = new FirewallDInterface(FW_SERVICE, FW_PATH, m_bus, this);
+        m_runtimeZone = new FirewallDZoneInterface(FW_SERVICE, FW_PATH, m_bus, this);
+        m_config = new FirewallDConfigInterface(FW_SERVICE, FW_CONFIG_PATH, m_bus, this);
+        m_properties = new DBusPropertiesInterface(FW_SERVICE, FW_PATH, m_bus, this);
+
+        // Zone object paths only move when firewalld reloads or the zone set changes
+        m_bus.connect(FW_SERVICE, FW_PATH, FW_INTERFACE, "Reloaded", this, SLOT(onZonesChanged()));
+        m_bus.connect(FW_SERVICE, FW_CONFIG_PATH, FW_CONFIG_INTERFACE, "ZoneAdded", this, SLOT(onZonesChanged()));
+        m_bus.connect(FW_SERVICE, QString(), FW_CONFIG_ZONE_INTERFACE, "Removed", this, SLOT(onZonesChanged()));
+        m_bus.connect(FW_SERVICE, QString(), FW_CONFIG_ZONE_INTERFACE, "Renamed", this, SLOT(onZonesChanged()));
+
+        // Permanent edits from anyone (us, firewall-cmd, scripts) end in Updated on the zone object
+        m_bus.connect(FW_SERVICE, QString(), FW_CONFIG_ZONE_INTERFACE, "Updated", this, SLOT(onZoneUpdated(QString)));
+
+        connectChangeSignals();
+    }
+
+    emit opened(m_connected);
+}
+
+void FirewallWorker::execute(const Command &command)
+{
+    if (!m_connected) {
+        fail(command.id, QDBusError(QDBusError::Disconnected, "Cannot connect to system bus"));
+        return;
+    }
+
+    switch (command.kind) {
+    case Call:
+        send(command.id, command.call);
+        break;
+    case ReadZone:
+        readZone(command.zone, [this, id = command.id](bool found, const ZoneSettings &settings) {
+            DBusResult result;
+            if (found) result.value = QVariant::fromValue(settings);
+            else result.error = QDBusError(QDBusError::UnknownObject, "No such zone");
+            emit finished(id, result);
+        });
+        break;
+    case ReadState:
+        readState(command.id);
+        break;
+    }
+}
+
+void FirewallWorker::fail(quint64 id, const QDBusError &error)
+{
+    DBusResult result;
+    result.error = error;
+    emit finished(id, result);
+}
+
+// Every call goes through here; traced from queueing until its reply is handled
+void FirewallWorker::watchCall(const QString &path, const QString &interface, const QString &method,
+                               const QDBusPendingCall &call,
+                               const std::function<void(QDBusPendingCallWatcher *)> &handler)
+{
+    const qint64 start = CallTrace::now();
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, path, interface, method, start, handler](QDBusPendingCallWatcher *w) {
+        m_trace->record(interface, method, path, start, CallTrace::now() - start,
+                        CallTrace::replySize(w->reply().arguments()), w->isError() ? w->error().name() : QString());
+        handler(w);
+        w->deleteLater();
+    });
+}
+
+void FirewallWorker::watchCall(const QDBusAbstractInterface *target, const QString &method,
+                               const QDBusPendingCall &call,
+                               const std::function<void(QDBusPendingCallWatcher *)> &handler)
+{
+    watchCall(target->path(), target->interface(), method, call, handler);
+}
+
+void FirewallWorker::send(quint64 id, const DBusCall &call)
+{
+    switch (call.target) {
+    case DBusCall::Main:
+        invoke(id, call, m_fw);
+        break;
+    case DBusCall::RuntimeZone:
+        invoke(id, call, m_runtimeZone);
+        break;
+    case DBusCall::Config:
+        invoke(id, call, m_config);
+        break;
+    case DBusCall::ConfigIPSet:
+        invoke(id, call, configIPSet(call.object));
+        break;
+    case DBusCall::Properties:
+        invoke(id, call, m_properties);
+        break;
+    case DBusCall::ConfigZone:
+        resolveZone(call.object, [this, id, call](const QString &path) {
+            if (path.isEmpty()) fail(id, QDBusError(QDBusError::UnknownObject, "Could not find path for zone: " + call.object));
+            else invoke(id, call, configZone(path));
+        });
+        break;
+    }
+}
+
+void FirewallWorker::invoke(quint64 id, const DBusCall &call, QDBusAbstractInterface *proxy)
+{
+    watchCall(proxy, call.method, call.invoke(proxy), [this, id, decode = call.decode](QDBusPendingCallWatcher *w) {
+        DBusResult result;
+        if (w->isError()) {
+            result.error = w->error();
+        } else {
+            const QDBusMessage reply = w->reply();
+            result.arguments = reply.arguments();
+            if (decode) result.value = decode(reply);
+        }
+        emit finished(id, result);
+    });
+}
+
+// === CHANGE SIGNALS ===
+
+void FirewallWorker::connectChangeSignals()
+{
+    // 1. Globals
+    connect(m_fw, &FirewallDInterface::DefaultZoneChanged, this, &FirewallWorker::defaultZoneChanged);
+    connect(m_fw, &FirewallDInterface::PanicModeEnabled, this, [this]() { emit panicChanged(true); });
+    connect(m_fw, &FirewallDInterface::PanicModeDisabled, this, [this]() { emit panicChanged(false); });
+    connect(m_fw, &FirewallDInterface::LogDeniedChanged, this, &FirewallWorker::logDeniedChanged);
+
+    // 2. Runtime zone members: not shown, only passed on as runtimeChanged
+    const auto changed = [this](const QString &zone) { emit runtimeChanged(zone); };
+    connect(m_runtimeZone, &FirewallDZoneInterface::ServiceAdded, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::ServiceRemoved, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::PortAdded, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::PortRemoved, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::SourceAdded, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::SourceRemoved, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::MasqueradeAdded, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::MasqueradeRemoved, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::ForwardPortAdded, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::ForwardPortRemoved, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::IcmpBlockInversionAdded, this, changed);
+    connect(m_runtimeZone, &FirewallDZoneInterface::IcmpBlockInversionRemoved, this, changed);
+}
+
+void FirewallWorker::onZonesChanged()
+{
+    // Reloaded, or a zone came or went: paths may have moved
+    invalidateZonePaths();
+    emit zonesChanged();
+}
+
+void FirewallWorker::onZoneUpdated(const QString &name)
+{
+    emit zoneUpdated(name);
+}
+
+// === ZONE PATH CACHE ===
+// Filled as a side effect of readZone(), which every refresh runs for every zone.
+
+void FirewallWorker::resolveZone(const QString &zoneName, const PathReader &done)
+{
+    if (zoneName.isEmpty()) {
+        done(QString());
+        return;
+    }
+
+    auto cached = m_zonePaths.constFind(zoneName);
+    if (cached != m_zonePaths.constEnd()) {
+        done(cached->path());
+        return;
+    }
+
+    const quint64 pathGeneration = m_zonePathGeneration;
+    watchCall(m_config, "getZoneByName", m_config->getZoneByName(zoneName), [this, zoneName, pathGeneration, done](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<QDBusObjectPath> reply = *w;
+        if (!reply.isValid()) {
+            done(QString());
+            return;
+        }
+        if (pathGeneration == m_zonePathGeneration) m_zonePaths.insert(zoneName, reply.value());
+        done(reply.value().path());
+    });
+}
+
+FirewallDConfigZoneInterface *FirewallWorker::configZone(const QString &zonePath)
+{
+    FirewallDConfigZoneInterface *&proxy = m_zoneProxies[zonePath];
+    if (!proxy) proxy = new FirewallDConfigZoneInterface(FW_SERVICE, zonePath, m_bus, this);
+    return proxy;
+}
+
+FirewallDConfigIPSetInterface *FirewallWorker::configIPSet(const QString &ipsetPath)
+{
+    FirewallDConfigIPSetInterface *&proxy = m_ipsetProxies[ipsetPath];
+    if (!proxy) proxy = new FirewallDConfigIPSetInterface(FW_SERVICE, ipsetPath, m_bus, this);
+    return proxy;
+}
+
+void FirewallWorker::invalidateZonePaths()
+{
+    // Replies from before an invalidation must not repopulate the cache
+    ++m_zonePathGeneration;
+
+    // Proxies are bound to a path that may now name another zone or ipset
+    for (FirewallDConfigZoneInterface *proxy : std::as_const(m_zoneProxies)) proxy->deleteLater();
+    m_zoneProxies.clear();
+    for (FirewallDConfigIPSetInterface *proxy : std::as_const(m_ipsetProxies)) proxy->deleteLater();
+    m_ipsetProxies.clear();
+    m_zonePaths.clear();
+}
+
+// === READS ===
+
+void FirewallWorker::readZone(const QString &zoneName, const ZoneReader &done)
+{
+    // A. Permanent Path (REQUIRED for Services/Ports)
+    resolveZone(zoneName, [this, done](const QString &path) {
+        if (path.isEmpty()) done(false, ZoneSettings());
+        else fetchZone(path, done);
+    });
+}
+
+void FirewallWorker::fetchZone(const QString &zonePath, const ZoneReader &done)
+{
+    // B. Whole permanent zone in one call
+    if (m_legacyZoneSettings) {
+        fetchLegacyZone(zonePath, done);
+        return;
+    }
+
+    FirewallDConfigZoneInterface *zone = configZone(zonePath);
+    watchCall(zone, "getSettings2", zone->getSettings2(), [this, zonePath, done](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<QVariantMap> reply = *w;
+        if (reply.isValid()) {
+            done(true, ZoneSettings::fromVariantMap(reply.value()));
+        } else if (reply.error().type() == QDBusError::UnknownMethod) {
+            // firewalld < 0.9
+            m_legacyZoneSettings = true;
+            fetchLegacyZone(zonePath, done);
+        } else {
+            done(false, ZoneSettings());
+        }
+    });
+}
+
+void FirewallWorker::fetchLegacyZone(const QString &zonePath, const ZoneReader &done)
+{
+    // Not in the bundled XML; the legacy tuple is demarshalled by hand
+    FirewallDConfigZoneInterface *zone = configZone(zonePath);
+    watchCall(zone, "getSettings", zone->asyncCall("getSettings"), [done](QDBusPendingCallWatcher *w) {
+        const QDBusMessage msg = w->reply();
+        if (msg.type() == QDBusMessage::ReplyMessage && !msg.arguments().isEmpty())
+            done(true, ZoneSettings::fromLegacyArgument(msg.arguments().at(0).value<QDBusArgument>()));
+        else
+            done(false, ZoneSettings());
+    });
+}
+
+// One in-flight state read, handed over once the last call has answered
+struct FirewallWorker::StateJob {
+    quint64 id = 0;
+    int pending = 0;
+    QSharedPointer<FirewallState> state = QSharedPointer<FirewallState>::create();
+};
+
+void FirewallWorker::readState(quint64 id)
+{
+    auto job = QSharedPointer<StateJob>::create();
+    job->id = id;
+
+    // 1. Global state and the zone list (all independent, sent at once)
+    job->pending += 4;
+
+    watchCall(m_fw, "queryPanicMode", m_fw->queryPanicMode(), [this, job](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<bool> reply = *w;
+        job->state->panic = reply.isValid() && reply.value();
+        finishStateCall(job);
+    });
+
+    watchCall(m_fw, "getLogDenied", m_fw->getLogDenied(), [this, job](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<QString> reply = *w;
+        if (reply.isValid()) job->state->logDenied = reply.value();
+        finishStateCall(job);
+    });
+
+    watchCall(m_fw, "getDefaultZone", m_fw->getDefaultZone(), [this, job](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<QString> reply = *w;
+        if (reply.isValid()) job->state->defaultZone = reply.value();
+        finishStateCall(job);
+    });
+
+    // 2. Every zone's settings in parallel, so switching the view never waits on the bus
+    watchCall(m_config, "getZoneNames", m_config->getZoneNames(), [this, job](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<QStringList> reply = *w;
+        if (reply.isValid()) {
+            job->state->zoneNames = reply.value();
+            job->state->zoneNames.sort();
+
+            for (const QString &name : std::as_const(job->state->zoneNames)) {
+                job->pending++;
+                readZone(name, [this, job, name](bool found, const ZoneSettings &settings) {
+                    if (found) job->state->zones.insert(name, settings);
+                    else job->state->complete = false;
+                    finishStateCall(job);
+                });
+            }
+        } else {
+            job->state->complete = false;
+        }
+        finishStateCall(job);
+    });
+}
+
+void FirewallWorker::finishStateCall(const QSharedPointer<StateJob> &job)
+{
+    if (--job->pending > 0) return;
+
+    DBusResult result;
+    result.value = QVariant::fromValue(FirewallStatePtr(job->state));
+    emit finished(job->id, result);
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusPendingCall>
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include <atomic>
+#include <functional>
+
+#include "spscqueue.h"
+#include "zonesettings.h"
+
+class QDBusAbstractInterface;
+class QDBusPendingCallWatcher;
+class CallTrace;
+class DBusPropertiesInterface;
+class FirewallDInterface;
+class FirewallDZoneInterface;
+class FirewallDConfigInterface;
+class FirewallDConfigZoneInterface;
+class FirewallDConfigIPSetInterface;
+
+// One firewalld method call, described on the GUI thread and made by the worker
+// through its generated proxy: DBusCall::configZone(zone, "addPort",
+// [=](auto *z) { return z->addPort(port, protocol); }). Calls on a config.zone
+// or config.ipset object name it; the worker finds the proxy.
+struct DBusCall {
+    template <typename Proxy>
+    using Call = std::function<QDBusPendingCall(Proxy *proxy)>;
+    using Invoke = Call<QDBusAbstractInterface>;
+    // Runs on the worker thread, so decoding big replies costs the GUI nothing
+    using Decoder = std::function<QVariant(const QDBusMessage &reply)>;
+
+    enum Target { Main, RuntimeZone, Config, ConfigZone, ConfigIPSet, Properties };
+
+    Target target = Main;
+    QString method; // for traces only; what is sent is whatever `invoke` calls
+    QString object; // ConfigZone: the zone name; ConfigIPSet: the object path
+    Invoke invoke;
+    Decoder decode;
+
+    static DBusCall main(const QString &method, const Call<FirewallDInterface> &invoke);
+    static DBusCall runtimeZone(const QString &method, const Call<FirewallDZoneInterface> &invoke);
+    static DBusCall config(const QString &method, const Call<FirewallDConfigInterface> &invoke);
+    static DBusCall configZone(const QString &zone, const QString &method, const Call<FirewallDConfigZoneInterface> &invoke);
+    static DBusCall configIPSet(const QString &path, const QString &method, const Call<FirewallDConfigIPSetInterface> &invoke);
+    static DBusCall mainProperty(const QString &name);
+};
+
+struct DBusResult {
+    QDBusError error;        // NoError on success
+    QVariantList arguments;  // the reply as QtDBus hands it over
+    QVariant value;          // what the call's decoder made of it
+
+    bool isError() const { return error.isValid(); }
+};
+
+// firewalld reports a side that already matches as ALREADY_ENABLED / NOT_ENABLED
+bool isBenignFirewallError(const QDBusError &error);
+
+// Everything one refresh reads; never modified once handed over
+struct FirewallState {
+    QString defaultZone;
+    bool panic = false;
+    QString logDenied = QStringLiteral("off"); // all, unicast, broadcast, multicast or off
+    QStringList zoneNames; // sorted
+    QHash<QString, ZoneSettings> zones;
+    bool complete = true; // false if the zone list or a listed zone could not be read
+};
+using FirewallStatePtr = QSharedPointer<const FirewallState>;
+
+Q_DECLARE_METATYPE(DBusResult)
+Q_DECLARE_METATYPE(FirewallStatePtr)
+
+// All firewalld I/O, on its own thread and bus connection. Only FirewallConnection talks to it.
+class FirewallWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind { Call, ReadZone, ReadState };
+
+    struct Command {
+        Kind kind = Call;
+        quint64 id = 0;
+        DBusCall call;  // Call
+        QString zone;   // ReadZone
+    };
+
+    // A non-empty address names a private bus to use instead of the well-known one.
+    // Every call is recorded in `trace`, which must outlive the worker.
+    FirewallWorker(QDBusConnection::BusType bus, const QString &address, const QString &connectionName,
+                   CallTrace *trace);
+    ~FirewallWorker() override;
+
+    // Producer side, FirewallConnection's thread only. False when the queue is full.
+    bool submit(Command &&command);
+
+    // Worker thread
+    void open();
+    void drain();
+
+signals:
+    void opened(bool connected);
+    void finished(quint64 id, const DBusResult &result);
+
+    // firewalld events, already decoded
+    void zonesChanged(); // reloaded, or a zone came or went
+    void zoneUpdated(const QString &zone);
+    void runtimeChanged(const QString &zone); // runtime only; the permanent config is unchanged
+    void defaultZoneChanged(const QString &zone);
+    void panicChanged(bool enabled);
+    void logDeniedChanged(const QString &value);
+
+private slots:
+    void onZonesChanged();
+    void onZoneUpdated(const QString &name);
+
+private:
+    using ZoneReader = std::function<void(bool found, const ZoneSettings &settings)>;
+    using PathReader = std::function<void(const QString &path)>;
+
+    struct StateJob;
+
+    void execute(const Command &command);
+    void connectChangeSignals();
+    void watchCall(const QString &path, const QString &interface, const QString &method,
+                   const QDBusPendingCall &call, const std::function<void(QDBusPendingCallWatcher *)> &handler);
+    void watchCall(const QDBusAbstractInterface *target, const QString &method,
+                   const QDBusPendingCall &call, const std::function<void(QDBusPendingCallWatcher *)> &handler);
+    void send(quint64 id, const DBusCall &call);
+    void invoke(quint64 id, const DBusCall &call, QDBusAbstractInterface *proxy);
+    void resolveZone(const QString &zoneName, const PathReader &done);
+    void readZone(const QString &zoneName, const ZoneReader &done);
+    void fetchZone(const QString &zonePath, const ZoneReader &done);
+    void fetchLegacyZone(const QString &zonePath, const ZoneReader &done);
+    void readState(quint64 id);
+    void finishStateCall(const QSharedPointer<StateJob> &job);
+    FirewallDConfigZoneInterface *configZone(const QString &zonePath);
+    FirewallDConfigIPSetInterface *configIPSet(const QString &ipsetPath);
+    void invalidateZonePaths();
+    void fail(quint64 id, const QDBusError &error);
+
+    CallTrace *m_trace;
+
+    SpscQueue<Command, 1024> m_queue;
+    std::atomic<bool> m_wakePending{false}; // a drain() is posted and hasn't started
+
+    QDBusConnection::BusType m_busType;
+    QString m_busAddress;
+    QString m_connectionName;
+    QDBusConnection m_bus;
+    bool m_connected = false;
+
+    FirewallDInterface *m_fw = nullptr;
+    FirewallDZoneInterface *m_runtimeZone = nullptr;
+    FirewallDConfigInterface *m_config = nullptr;
+    DBusPropertiesInterface *m_properties = nullptr;
+    QHash<QString, FirewallDConfigZoneInterface *> m_zoneProxies; // by object path
+    QHash<QString, FirewallDConfigIPSetInterface *> m_ipsetProxies; // by object path
+
+    QHash<QString, QDBusObjectPath> m_zonePaths;
+    quint64 m_zonePathGeneration = 0;
+    bool m_legacyZoneSettings = false;
+};
@@ -1,6 +1,8 @@
 #include <QGuiApplication>
+#include <QCommandLineParser>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQmlExtensionPlugin>
 #include <QQuickStyle>
 #include <QUrl>
 #include <QSurfaceFormat>
@@ -12,16 +14,22 @@
 #include <KLocalizedContext>
 #include <KAboutData>
 #include <MauiKit4/Core/mauiapp.h>
-#include "firewallbackend.h"
+#include "startuptiming.h"
+
+// The UI module is linked in statically; this keeps its type registrations
+Q_IMPORT_QML_PLUGIN(org_nitrux_firewallPlugin)
 
 int main(int argc, char *argv[])
 {
+    StartupTiming::start();
+
     // 1. ENABLE WINDOW TRANSPARENCY
     QSurfaceFormat format;
     format.setAlphaBufferSize(8);
     QSurfaceFormat::setDefaultFormat(format);
 
     QGuiApplication app(argc, argv);
+    StartupTiming::mark("application created");
 
     QStringList paths = QIcon::themeSearchPaths();
     paths.append(":/icons");
@@ -65,22 +73,42 @@ int main(int argc, char *argv[])
 
     KAboutData::setApplicationData(about);
 
-    // 6. INITIALIZE MAUIKIT
+    // 6. COMMAND LINE
+    QCommandLineParser parser;
+    const QCommandLineOption traceOption(QStringLiteral("trace-file"),
+                                         i18n("On exit, write the session's firewalld calls to <file> as Chrome trace-event JSON."),
+                                         QStringLiteral("file"));
+    const QCommandLineOption deniedLogOption(QStringLiteral("denied-log"),
+                                             i18n("Read denied packets from <file> (a log file or FIFO) instead of /dev/kmsg."),
+                                             QStringLiteral("file"));
+    parser.addOption(traceOption);
+    parser.addOption(deniedLogOption);
+    about.setupCommandLine(&parser);
+    parser.process(app);
+    about.processCommandLine(&parser);
+    if (parser.isSet(traceOption)) qputenv("CINDERWARD_TRACE_FILE", parser.value(traceOption).toLocal8Bit());
+    if (parser.isSet(deniedLogOption)) qputenv("CINDERWARD_DENIED_LOG", parser.value(deniedLogOption).toLocal8Bit());
+
+    // 7. INITIALIZE MAUIKIT
     // Initializes the singleton and theming
     MauiApp::instance()->setIconName("qrc:/assets/cinderward.svg"); 
 
-    qmlRegisterType<FirewallBackend>("org.nitrux.firewall", 1, 0, "FirewallBackend");
-
     QQmlApplicationEngine engine;
     engine.rootContext()->setContextObject(new KLocalizedContext(&engine));
 
-    const QUrl url(QStringLiteral("qrc:/qml/main.qml"));
-    QObject::connect(&engine, &QQmlApplicationEngine::objectCreated,
-                     &app, [url](QObject *obj, const QUrl &objUrl) {
-        if (!obj && url == objUrl) QCoreApplication::exit(-1);
-    }, Qt::QueuedConnection);
+    QObject::connect(&engine, &QQmlApplicationEngine::objectCreationFailed,
+                     &app, []() { QCoreApplication::exit(-1); }, Qt::QueuedConnection);
 
-    engine.load(url);
+    // Compiled ahead of time by qt_add_qml_module; nothing is parsed here
+    engine.loadFromModule("org.nitrux.firewall", "Main");
+    StartupTiming::mark("QML loaded");
+
+    // 8. STARTUP TIMING
+    if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().value(0))) {
+        QObject::connect(window, &QQuickWindow::frameSwapped, &app, []() {
+            StartupTiming::mark("first frame");
+        }, Qt::SingleShotConnection);
+    }
 
     return app.exec();
 }
@@ -0,0 +1,204 @@
+#include "policy.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+const int POLICY_VERSION = 1;
+
+// === APPLY ===
+
+template <typename T>
+static void assignList(QList<T> &live, const QList<T> &wanted)
+{
+    QList<T> sortedLive = live;
+    QList<T> sortedWanted = wanted;
+    std::sort(sortedLive.begin(), sortedLive.end());
+    std::sort(sortedWanted.begin(), sortedWanted.end());
+    if (sortedLive != sortedWanted) live = wanted;
+}
+
+void ZonePolicy::applyTo(ZoneSettings &zone) const
+{
+    if (target) zone.target = *target;
+    if (services) assignList(zone.services, *services);
+    if (ports) assignList(zone.ports, *ports);
+    if (sources) assignList(zone.sources, *sources);
+    if (forwardPorts) assignList(zone.forwardPorts, *forwardPorts);
+    if (masquerade) zone.masquerade = *masquerade;
+    if (icmpBlocks) assignList(zone.icmpBlocks, *icmpBlocks);
+    if (icmpBlockInversion) zone.icmpBlockInversion = *icmpBlockInversion;
+}
+
+// === READING ===
+
+static bool readStrings(const QJsonValue &value, QStringList &out)
+{
+    if (!value.isArray()) return false;
+    for (const QJsonValue &entry : value.toArray()) {
+        if (!entry.isString()) return false;
+        out.append(entry.toString());
+    }
+    return true;
+}
+
+static bool readZone(const QJsonObject &json, ZonePolicy &zone, QString &error)
+{
+    for (auto it = json.constBegin(); it != json.constEnd(); ++it) {
+        const QString &key = it.key();
+        const QJsonValue &value = it.value();
+        bool ok = true;
+
+        if (key == "target") {
+            ok = value.isString();
+            zone.target = value.toString();
+        } else if (key == "services" || key == "sources" || key == "icmpBlocks") {
+            QStringList list;
+            ok = readStrings(value, list);
+            (key == "services" ? zone.services : key == "sources" ? zone.sources : zone.icmpBlocks) = list;
+        } else if (key == "ports") {
+            QStringList list;
+            ok = readStrings(value, list);
+            QList<ZonePort> ports;
+            for (const QString &entry : std::as_const(list)) {
+                const QStringList parts = entry.split('/');
+                if (parts.size() != 2 || parts.at(0).isEmpty() || parts.at(1).isEmpty()) {
+                    error = "\"" + entry + "\" is not port/protocol";
+                    return false;
+                }
+                ports.append({parts.at(0), parts.at(1).toLower()});
+            }
+            zone.ports = ports;
+        } else if (key == "forwardPorts") {
+            ok = value.isArray();
+            QList<ForwardPort> forwards;
+            for (const QJsonValue &entry : value.toArray()) {
+                const QJsonObject f = entry.toObject();
+                if (f.value("port").toString().isEmpty() || f.value("protocol").toString().isEmpty()) {
+                    error = "forward ports need a port and a protocol";
+                    return false;
+                }
+                forwards.append({f.value("port").toString(), f.value("protocol").toString().toLower(),
+                                 f.value("toPort").toString(), f.value("toAddr").toString()});
+            }
+            zone.forwardPorts = forwards;
+        } else if (key == "masquerade") {
+            ok = value.isBool();
+            zone.masquerade = value.toBool();
+        } else if (key == "icmpBlockInversion") {
+            ok = value.isBool();
+            zone.icmpBlockInversion = value.toBool();
+        } else {
+            error = "unknown key \"" + key + "\"";
+            return false;
+        }
+
+        if (!ok) {
+            error = "\"" + key + "\" has the wrong type";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Policy::fromJson(const QByteArray &json, Policy &out, QString &error)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (!doc.isObject()) {
+        error = parseError.error != QJsonParseError::NoError ? parseError.errorString() : "not a JSON object";
+        return false;
+    }
+
+    static const QStringList logDeniedValues{"all", "unicast", "broadcast", "multicast", "off"};
+
+    const QJsonObject root = doc.object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it) {
+        const QString &key = it.key();
+        const QJsonValue &value = it.value();
+        bool ok = true;
+
+        if (key == "version") {
+            ok = value.isDouble();
+            if (ok && value.toInt() != POLICY_VERSION) {
+                error = QString("unsupported version %1").arg(value.toInt());
+                return false;
+            }
+        } else if (key == "defaultZone") {
+            ok = value.isString();
+            out.defaultZone = value.toString();
+        } else if (key == "logDenied") {
+            if (!logDeniedValues.contains(value.toString())) {
+                error = "\"logDenied\" is not one of " + logDeniedValues.join(", ");
+                return false;
+            }
+            out.logDenied = value.toString();
+        } else if (key == "panic") {
+            ok = value.isBool();
+            out.panic = value.toBool();
+        } else if (key == "zones") {
+            ok = value.isObject();
+            const QJsonObject zones = value.toObject();
+            for (auto zoneIt = zones.constBegin(); zoneIt != zones.constEnd(); ++zoneIt) {
+                ZonePolicy zone;
+                QString zoneError;
+                if (!zoneIt.value().isObject()) zoneError = "not an object";
+                if (!zoneError.isEmpty() || !readZone(zoneIt.value().toObject(), zone, zoneError)) {
+                    error = zoneIt.key() + ": " + zoneError;
+                    return false;
+                }
+                out.zones.insert(zoneIt.key(), zone);
+            }
+        } else {
+            error = "unknown key \"" + key + "\"";
+            return false;
+        }
+
+        if (!ok) {
+            error = "\"" + key + "\" has the wrong type";
+            return false;
+        }
+    }
+    return true;
+}
+
+// === WRITING ===
+
+QByteArray Policy::toJson(const QString &defaultZone, const QString &logDenied, bool panic,
+                          const QHash<QString, ZoneSettings> &zones)
+{
+    QJsonObject zoneObjects;
+    for (auto it = zones.constBegin(); it != zones.constEnd(); ++it) {
+        const ZoneSettings &z = it.value();
+
+        QJsonArray ports;
+        for (const ZonePort &p : z.ports) ports.append(p.port + "/" + p.protocol);
+
+        QJsonArray forwards;
+        for (const ForwardPort &f : z.forwardPorts) {
+            forwards.append(QJsonObject{{"port", f.port}, {"protocol", f.protocol}, {"toPort", f.toPort}, {"toAddr", f.toAddr}});
+        }
+
+        zoneObjects.insert(it.key(), QJsonObject{
+            {"target", z.target},
+            {"services", QJsonArray::fromStringList(z.services)},
+            {"ports", ports},
+            {"sources", QJsonArray::fromStringList(z.sources)},
+            {"forwardPorts", forwards},
+            {"masquerade", z.masquerade},
+            {"icmpBlocks", QJsonArray::fromStringList(z.icmpBlocks)},
+            {"icmpBlockInversion", z.icmpBlockInversion},
+        });
+    }
+
+    const QJsonObject root{
+        {"version", POLICY_VERSION},
+        {"defaultZone", defaultZone},
+        {"logDenied", logDenied},
+        {"panic", panic},
+        {"zones", zoneObjects},
+    };
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
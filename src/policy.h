@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+#include "zonesettings.h"
+
+// Declarative firewall state, as JSON:
+//
+//   {
+//     "version": 1,
+//     "defaultZone": "public",
+//     "logDenied": "off",
+//     "panic": false,
+//     "zones": {
+//       "public": {
+//         "target": "default",
+//         "services": ["ssh"],
+//         "ports": ["8080/tcp", "6000-6010/udp"],
+//         "sources": ["192.168.1.0/24"],
+//         "forwardPorts": [{"port": "80", "protocol": "tcp", "toPort": "8080", "toAddr": "10.0.0.2"}],
+//         "masquerade": false,
+//         "icmpBlocks": [],
+//         "icmpBlockInversion": false
+//       }
+//     }
+//   }
+//
+// Every key is optional; whatever is left out stays as it is.
+struct ZonePolicy {
+    std::optional<QString> target;
+    std::optional<QStringList> services;
+    std::optional<QList<ZonePort>> ports;
+    std::optional<QStringList> sources;
+    std::optional<QList<ForwardPort>> forwardPorts;
+    std::optional<bool> masquerade;
+    std::optional<QStringList> icmpBlocks;
+    std::optional<bool> icmpBlockInversion;
+
+    // Lists that only differ in order keep the live order, so they don't count as a change
+    void applyTo(ZoneSettings &zone) const;
+};
+
+struct Policy {
+    std::optional<QString> defaultZone;
+    std::optional<QString> logDenied;
+    std::optional<bool> panic;
+    QMap<QString, ZonePolicy> zones;
+
+    static bool fromJson(const QByteArray &json, Policy &out, QString &error);
+
+    // The full state, every key present
+    static QByteArray toJson(const QString &defaultZone, const QString &logDenied, bool panic,
+                             const QHash<QString, ZoneSettings> &zones);
+};
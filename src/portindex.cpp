@@ -0,0 +1,118 @@
+#include "portindex.h"
+
+#include <algorithm>
+
+bool PortIndex::parseRange(const QString &text, int &first, int &last)
+{
+    const QString trimmed = text.trimmed();
+    const qsizetype dash = trimmed.indexOf('-');
+
+    bool ok = false, okLast = false;
+    first = (dash < 0 ? trimmed : trimmed.left(dash)).toInt(&ok);
+    last = dash < 0 ? first : trimmed.mid(dash + 1).toInt(&okLast);
+    if (dash < 0) okLast = ok;
+
+    return ok && okLast && first >= 0 && first <= last && last <= 65535;
+}
+
+void PortIndex::rebuild(const QHash<QString, ZoneSettings> &zones, const ServicePorts &servicePorts)
+{
+    m_trees.clear();
+
+    auto add = [this](const QString &zone, Kind kind, const QString &item, const ZonePort &port) {
+        Entry entry;
+        if (!parseRange(port.port, entry.first, entry.last)) return;
+        entry.protocol = port.protocol;
+        entry.zone = zone;
+        entry.kind = kind;
+        entry.item = item;
+        m_trees[port.protocol].entries.push_back(entry);
+    };
+
+    for (auto it = zones.constBegin(); it != zones.constEnd(); ++it) {
+        const ZoneSettings &zone = it.value();
+
+        for (const ZonePort &p : zone.ports) add(it.key(), Port, p.port + "/" + p.protocol, p);
+
+        for (const QString &service : zone.services) {
+            for (const ZonePort &p : servicePorts(service)) add(it.key(), Service, service, p);
+        }
+
+        for (const ForwardPort &f : zone.forwardPorts) {
+            const QString item = f.port + "/" + f.protocol + " -> " + f.toAddr + ":" + f.toPort;
+            add(it.key(), Forward, item, ZonePort{f.port, f.protocol});
+        }
+    }
+
+    for (Tree &tree : m_trees) tree.build();
+}
+
+void PortIndex::Tree::build()
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.first < b.first; });
+    maxLast.assign(entries.size(), 0);
+    buildRange(0, qsizetype(entries.size()));
+}
+
+// The middle of [lo, hi) is the subtree root, its halves the children
+int PortIndex::Tree::buildRange(qsizetype lo, qsizetype hi)
+{
+    if (lo >= hi) return -1;
+
+    const qsizetype mid = lo + (hi - lo) / 2;
+    const int left = buildRange(lo, mid);
+    const int right = buildRange(mid + 1, hi);
+    maxLast[mid] = std::max({entries[mid].last, left, right});
+    return maxLast[mid];
+}
+
+void PortIndex::Tree::query(qsizetype lo, qsizetype hi, int first, int last, QList<Entry> &out) const
+{
+    if (lo >= hi) return;
+
+    const qsizetype mid = lo + (hi - lo) / 2;
+    if (maxLast[mid] < first) return; // nothing below reaches the query
+
+    query(lo, mid, first, last, out);
+
+    // Everything to the right starts later still
+    if (entries[mid].first > last) return;
+    if (entries[mid].last >= first) out.append(entries[mid]);
+    query(mid + 1, hi, first, last, out);
+}
+
+QList<PortIndex::Entry> PortIndex::overlapping(const QString &protocol, int first, int last) const
+{
+    QList<Entry> out;
+    auto tree = m_trees.constFind(protocol);
+    if (tree != m_trees.constEnd()) tree->query(0, qsizetype(tree->entries.size()), first, last, out);
+    return out;
+}
+
+QList<PortIndex::Redundancy> PortIndex::redundant(const QString &zone) const
+{
+    QList<Redundancy> found;
+
+    for (const Tree &tree : m_trees) {
+        for (const Entry &entry : tree.entries) {
+            if (entry.zone != zone || entry.kind != Port) continue;
+
+            QList<Entry> hits;
+            tree.query(0, qsizetype(tree.entries.size()), entry.first, entry.last, hits);
+
+            for (const Entry &other : std::as_const(hits)) {
+                if (other.zone != zone || (other.kind == Port && other.item == entry.item)) continue;
+                if (other.first > entry.first || other.last < entry.last) continue;
+
+                // "80" and "80-80" cover each other; only flag one of the two
+                const bool same = other.first == entry.first && other.last == entry.last;
+                if (same && other.kind == Port && other.item > entry.item) continue;
+
+                found.append({entry, other});
+                break;
+            }
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+#include "zonesettings.h"
+
+// Every port opened in any zone (ports, services, forwards), as one interval tree
+// per protocol over a sorted array
+class PortIndex
+{
+public:
+    enum Kind { Port, Service, Forward };
+
+    struct Entry {
+        int first = 0;
+        int last = 0;
+        QString protocol;
+        QString zone;
+        Kind kind = Port;
+        QString item; // "1000-2000/tcp", a service name, or "80/tcp -> 10.0.0.2:8080"
+    };
+
+    struct Redundancy {
+        Entry entry;
+        Entry coveredBy;
+    };
+
+    using ServicePorts = std::function<QList<ZonePort>(const QString &service)>;
+
+    void rebuild(const QHash<QString, ZoneSettings> &zones, const ServicePorts &servicePorts);
+
+    // Entries overlapping [first, last] for the protocol, in port order
+    QList<Entry> overlapping(const QString &protocol, int first, int last) const;
+
+    // Explicit ports of the zone that another entry of the same zone already opens
+    QList<Redundancy> redundant(const QString &zone) const;
+
+    // "8080" or "1000-2000"
+    static bool parseRange(const QString &text, int &first, int &last);
+
+private:
+    struct Tree {
+        std::vector<Entry> entries; // by first port
+        std::vector<int> maxLast;   // highest last port in the subtree rooted at i
+
+        void build();
+        int buildRange(qsizetype lo, qsizetype hi);
+        void query(qsizetype lo, qsizetype hi, int first, int last, QList<Entry> &out) const;
+    };
+
+    QHash<QString, Tree> m_trees; // by protocol
+};
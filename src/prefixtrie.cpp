@@ -0,0 +1,206 @@
+#include "prefixtrie.h"
+
+#include <arpa/inet.h>
+
+#include <cstring>
+
+static int maxLength(PrefixTrie::Family family)
+{
+    return family == PrefixTrie::IPv4 ? 32 : 128;
+}
+
+static int bitAt(const PrefixTrie::Prefix &p, int depth)
+{
+    return depth < 64 ? int(p.hi >> (63 - depth) & 1) : int(p.lo >> (127 - depth) & 1);
+}
+
+static quint64 topBits(int bits)
+{
+    if (bits <= 0) return 0;
+    if (bits >= 64) return ~quint64(0);
+    return ~quint64(0) << (64 - bits);
+}
+
+PrefixTrie::PrefixTrie(Family family)
+    : m_family(family)
+{
+    m_nodes.emplace_back();
+}
+
+bool PrefixTrie::parse(const char *begin, const char *end, Prefix &out)
+{
+    // Longest valid text is an IPv4-mapped IPv6 address plus "/128"
+    char buf[64];
+    const qsizetype size = end - begin;
+    if (size <= 0 || size >= qsizetype(sizeof(buf))) return false;
+    std::memcpy(buf, begin, size);
+    buf[size] = '\0';
+
+    char *slash = std::strchr(buf, '/');
+    if (slash) *slash = '\0';
+
+    unsigned char bytes[16] = {};
+    if (std::strchr(buf, ':')) {
+        if (inet_pton(AF_INET6, buf, bytes) != 1) return false;
+        out.family = IPv6;
+    } else {
+        if (inet_pton(AF_INET, buf, bytes) != 1) return false;
+        out.family = IPv4;
+    }
+
+    out.length = maxLength(out.family);
+    if (slash) {
+        const char *digits = slash + 1;
+        if (*digits == '\0' || std::strlen(digits) > 3) return false;
+
+        int length = 0;
+        for (const char *c = digits; *c; ++c) {
+            if (*c < '0' || *c > '9') return false;
+            length = length * 10 + (*c - '0');
+        }
+        if (length > out.length) return false;
+        out.length = length;
+    }
+
+    out.hi = 0;
+    out.lo = 0;
+    for (int i = 0; i < 8; ++i) out.hi = out.hi << 8 | bytes[i];
+    for (int i = 8; i < 16; ++i) out.lo = out.lo << 8 | bytes[i];
+    if (out.family == IPv4) out.lo = 0; // inet_pton only wrote 4 bytes; hi now holds them on top
+
+    // Normalise: 10.1.2.3/8 is 10.0.0.0/8
+    out.hi &= topBits(out.length);
+    out.lo &= topBits(out.length - 64);
+    return true;
+}
+
+void PrefixTrie::insert(const Prefix &prefix)
+{
+    if (prefix.family != m_family) return;
+    m_inserted++;
+
+    // 1. Walk down, stopping early if a shorter prefix already covers this one
+    qint32 path[129];
+    qint32 node = 0;
+    path[0] = 0;
+
+    for (int depth = 0; depth < prefix.length; ++depth) {
+        if (m_nodes[node].full) return;
+
+        const int bit = bitAt(prefix, depth);
+        qint32 next = m_nodes[node].child[bit];
+        if (next < 0) {
+            next = qint32(m_nodes.size());
+            m_nodes.emplace_back(); // may move the pool; no references held across it
+            m_nodes[node].child[bit] = next;
+        }
+        node = next;
+        path[depth + 1] = node;
+    }
+
+    // 2. Everything below is now redundant
+    Node &leaf = m_nodes[node];
+    if (leaf.full) return;
+    leaf.full = true;
+    leaf.child[0] = leaf.child[1] = -1;
+
+    // 3. Fold complete sibling pairs upwards: 10.0.0.0/25 + 10.0.0.128/25 = 10.0.0.0/24
+    for (int depth = prefix.length; depth > 0; --depth) {
+        Node &parent = m_nodes[path[depth - 1]];
+        const qint32 a = parent.child[0];
+        const qint32 b = parent.child[1];
+        if (a < 0 || b < 0 || !m_nodes[a].full || !m_nodes[b].full) break;
+
+        parent.full = true;
+        parent.child[0] = parent.child[1] = -1;
+    }
+}
+
+bool PrefixTrie::insert(const QString &text)
+{
+    const QByteArray latin = text.trimmed().toLatin1();
+    Prefix prefix;
+    if (!parse(latin.constData(), latin.constData() + latin.size(), prefix) || prefix.family != m_family) return false;
+    insert(prefix);
+    return true;
+}
+
+static QString formatIPv6(quint64 hi, quint64 lo)
+{
+    quint16 groups[8];
+    for (int i = 0; i < 4; ++i) groups[i] = quint16(hi >> (48 - 16 * i));
+    for (int i = 0; i < 4; ++i) groups[4 + i] = quint16(lo >> (48 - 16 * i));
+
+    // RFC 5952: collapse the longest run of two or more zero groups
+    int bestStart = -1, bestLength = 0;
+    for (int i = 0; i < 8; ) {
+        if (groups[i] != 0) {
+            i++;
+            continue;
+        }
+        int j = i;
+        while (j < 8 && groups[j] == 0) j++;
+        if (j - i > bestLength && j - i >= 2) {
+            bestStart = i;
+            bestLength = j - i;
+        }
+        i = j;
+    }
+
+    QString text;
+    for (int i = 0; i < 8; ++i) {
+        if (i == bestStart) {
+            text += "::";
+            i += bestLength - 1;
+            continue;
+        }
+        if (!text.isEmpty() && !text.endsWith(':')) text += ':';
+        text += QString::number(groups[i], 16);
+    }
+    return text;
+}
+
+QStringList PrefixTrie::toStrings() const
+{
+    struct Frame {
+        qint32 node;
+        int depth;
+        quint64 hi;
+        quint64 lo;
+    };
+
+    QStringList out;
+    std::vector<Frame> stack{{0, 0, 0, 0}};
+
+    while (!stack.empty()) {
+        const Frame f = stack.back();
+        stack.pop_back();
+        const Node &node = m_nodes[f.node];
+
+        if (node.full) {
+            QString text;
+            if (m_family == IPv4) {
+                const quint32 a = quint32(f.hi >> 32);
+                text = QString("%1.%2.%3.%4").arg(a >> 24).arg(a >> 16 & 0xff).arg(a >> 8 & 0xff).arg(a & 0xff);
+            } else {
+                text = formatIPv6(f.hi, f.lo);
+            }
+            if (f.depth < maxLength(m_family)) text += '/' + QString::number(f.depth);
+            out.append(text);
+            continue;
+        }
+
+        // Right child first so the left (lower) half comes out first
+        for (int bit = 1; bit >= 0; --bit) {
+            if (node.child[bit] < 0) continue;
+            Frame child{node.child[bit], f.depth + 1, f.hi, f.lo};
+            if (bit) {
+                if (f.depth < 64) child.hi |= quint64(1) << (63 - f.depth);
+                else child.lo |= quint64(1) << (127 - f.depth);
+            }
+            stack.push_back(child);
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QStringList>
+#include <QtGlobal>
+
+#include <vector>
+
+// Binary radix tree over one address family; toStrings() yields the fewest CIDRs
+// covering exactly what was inserted
+class PrefixTrie
+{
+public:
+    enum Family { IPv4, IPv6 };
+
+    // An address as the top `length` bits of a 128-bit key; IPv4 sits in the top
+    // 32 bits of hi.
+    struct Prefix {
+        Family family = IPv4;
+        quint64 hi = 0;
+        quint64 lo = 0;
+        int length = 0;
+    };
+
+    explicit PrefixTrie(Family family);
+
+    // "a.b.c.d[/n]" or "v6addr[/n]"; host bits are masked off
+    static bool parse(const char *begin, const char *end, Prefix &out);
+
+    Family family() const { return m_family; }
+    void insert(const Prefix &prefix);
+    bool insert(const QString &text); // parse() + insert(), for entries read back from firewalld
+
+    qsizetype inserted() const { return m_inserted; }
+    bool isEmpty() const { return m_inserted == 0; }
+
+    // The aggregated prefixes, in address order. Hosts are written without a length.
+    QStringList toStrings() const;
+
+private:
+    struct Node {
+        qint32 child[2] = {-1, -1};
+        bool full = false;
+    };
+
+    Family m_family;
+    std::vector<Node> m_nodes;
+    qsizetype m_inserted = 0;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QObject>
+#include <QtQml/qqmlregistration.h>
+
+#include "callstatsmodel.h"
+#include "deniedlogmodel.h"
+#include "firewallbackend.h"
+#include "rulelistmodel.h"
+#include "servicecatalog.h"
+
+// QML names for the backend's types, kept here so cinderward-core stays free of QtQml
+
+struct FirewallBackendForeign {
+    Q_GADGET
+    QML_FOREIGN(FirewallBackend)
+    QML_NAMED_ELEMENT(FirewallBackend)
+};
+
+struct RuleListModelForeign {
+    Q_GADGET
+    QML_FOREIGN(RuleListModel)
+    QML_NAMED_ELEMENT(RuleListModel)
+    QML_UNCREATABLE("RuleListModel is provided by FirewallBackend.rules")
+};
+
+struct ServiceCatalogForeign {
+    Q_GADGET
+    QML_FOREIGN(ServiceCatalog)
+    QML_NAMED_ELEMENT(ServiceCatalog)
+    QML_UNCREATABLE("ServiceCatalog is provided by FirewallBackend.serviceCatalog")
+};
+
+struct CallStatsModelForeign {
+    Q_GADGET
+    QML_FOREIGN(CallStatsModel)
+    QML_NAMED_ELEMENT(CallStatsModel)
+    QML_UNCREATABLE("CallStatsModel is provided by FirewallBackend.callStats")
+};
+
+struct DeniedLogModelForeign {
+    Q_GADGET
+    QML_FOREIGN(DeniedLogModel)
+    QML_NAMED_ELEMENT(DeniedLogModel)
+    QML_UNCREATABLE("DeniedLogModel is provided by FirewallBackend.deniedLog")
+};
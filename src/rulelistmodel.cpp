@@ -0,0 +1,196 @@
+#include "rulelistmodel.h"
+#include "zonesettings.h"
+
+#include <QSet>
+
+#include <utility>
+
+RuleListModel::RuleListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int RuleListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rules.size();
+}
+
+QVariant RuleListModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid)) return QVariant();
+
+    const Rule &rule = m_rules.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case ValueRole: return rule.value;
+    case KindRole: return rule.kind;
+    case PortRole: return rule.port;
+    case ProtocolRole: return rule.protocol;
+    case ToPortRole: return rule.toPort;
+    case ToAddrRole: return rule.toAddr;
+    case SourceRole: return rule.source;
+    case ListeningRole:
+    case ListenersRole: {
+        QList<Listener> listeners;
+        if (!listenersFor(rule, listeners)) return role == ListeningRole ? QVariant() : QVariant(QString());
+        if (role == ListeningRole) return !listeners.isEmpty();
+
+        QStringList owners;
+        for (const Listener &l : std::as_const(listeners)) {
+            // Owners hidden from us still have a uid
+            const QString owner = l.pid > 0 ? QString("%1 (%2)").arg(l.process).arg(l.pid) : QString("uid %1").arg(l.uid);
+            if (!owners.contains(owner)) owners.append(owner);
+        }
+        return owners.join(", ");
+    }
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> RuleListModel::roleNames() const
+{
+    return {
+        {KindRole, "kind"},
+        {ValueRole, "value"},
+        {PortRole, "port"},
+        {ProtocolRole, "protocol"},
+        {ToPortRole, "toPort"},
+        {ToAddrRole, "toAddr"},
+        {SourceRole, "source"},
+        {ListeningRole, "listening"},
+        {ListenersRole, "listeners"},
+    };
+}
+
+bool RuleListModel::listenersFor(const Rule &rule, QList<Listener> &out) const
+{
+    if (!m_sockets) return false;
+
+    const auto lookup = [this, &out](const QString &port, const QString &protocol) {
+        int first = 0, last = 0;
+        if (!SocketTable::covers(protocol) || !PortIndex::parseRange(port, first, last)) return false;
+        // A rule opens nothing for a socket only this host can reach
+        for (const Listener &l : m_sockets->listening(protocol, first, last)) {
+            if (!l.loopback) out.append(l);
+        }
+        return true;
+    };
+
+    if (rule.kind == "port") return lookup(rule.port, rule.protocol);
+
+    if (rule.kind == "service") {
+        if (!m_servicePorts) return false;
+        bool known = false;
+        for (const ZonePort &p : m_servicePorts(rule.value)) known |= lookup(p.port, p.protocol);
+        return known;
+    }
+
+    // Forwards to another host are answered there, not here
+    if (rule.kind == "forward" && rule.toAddr.isEmpty())
+        return lookup(rule.toPort.isEmpty() ? rule.port : rule.toPort, rule.protocol);
+
+    return false;
+}
+
+void RuleListModel::setListeners(const SocketTablePtr &sockets, const PortIndex::ServicePorts &servicePorts)
+{
+    m_sockets = sockets;
+    m_servicePorts = servicePorts;
+    if (!m_rules.isEmpty()) emit dataChanged(index(0), index(m_rules.size() - 1), {ListeningRole, ListenersRole});
+}
+
+QList<RuleListModel::Rule> RuleListModel::rulesFor(const ZoneSettings &zone)
+{
+    QList<Rule> rules;
+    rules.reserve(zone.services.size() + zone.ports.size() + zone.sources.size() + zone.forwardPorts.size());
+
+    for (const QString &service : zone.services) rules.append({"service", service});
+
+    for (const ZonePort &p : zone.ports) {
+        Rule rule{"port", p.port + "/" + p.protocol};
+        rule.port = p.port;
+        rule.protocol = p.protocol;
+        rules.append(rule);
+    }
+
+    for (const QString &source : zone.sources) {
+        Rule rule{"source", source};
+        rule.source = source;
+        rules.append(rule);
+    }
+
+    for (const ForwardPort &f : zone.forwardPorts) {
+        Rule rule{"forward", QString("port=%1:proto=%2:toport=%3").arg(f.port, f.protocol, f.toPort)};
+        if (!f.toAddr.isEmpty()) rule.value += QString(":toaddr=%1").arg(f.toAddr);
+        rule.port = f.port;
+        rule.protocol = f.protocol;
+        rule.toPort = f.toPort;
+        rule.toAddr = f.toAddr;
+        rules.append(rule);
+    }
+
+    return rules;
+}
+
+void RuleListModel::setZone(const ZoneSettings &zone)
+{
+    const QList<Rule> next = rulesFor(zone);
+
+    // 1. Skip the common head and tail; a single edit leaves only a small middle
+    qsizetype head = 0;
+    const qsizetype common = qMin(m_rules.size(), next.size());
+    while (head < common && m_rules.at(head) == next.at(head)) head++;
+
+    qsizetype tail = 0;
+    while (tail < common - head && m_rules.at(m_rules.size() - 1 - tail) == next.at(next.size() - 1 - tail)) tail++;
+
+    const qsizetype oldEnd = m_rules.size() - tail;
+    const qsizetype newEnd = next.size() - tail;
+    if (head == oldEnd && head == newEnd) return;
+
+    QSet<QString> oldKeys, newKeys;
+    for (qsizetype i = head; i < oldEnd; ++i) oldKeys.insert(m_rules.at(i).key());
+    for (qsizetype i = head; i < newEnd; ++i) newKeys.insert(next.at(i).key());
+
+    // 2. Rules on both sides must keep their order, or rows would have to move
+    QList<Rule> keptOld, keptNew;
+    for (qsizetype i = head; i < oldEnd; ++i) if (newKeys.contains(m_rules.at(i).key())) keptOld.append(m_rules.at(i));
+    for (qsizetype i = head; i < newEnd; ++i) if (oldKeys.contains(next.at(i).key())) keptNew.append(next.at(i));
+
+    if (keptOld != keptNew) {
+        beginResetModel();
+        m_rules = next;
+        endResetModel();
+        return;
+    }
+
+    // 3. Remove runs from the back so earlier rows keep their indexes
+    for (qsizetype last = oldEnd - 1; last >= head; ) {
+        if (newKeys.contains(m_rules.at(last).key())) {
+            last--;
+            continue;
+        }
+        qsizetype first = last;
+        while (first > head && !newKeys.contains(m_rules.at(first - 1).key())) first--;
+
+        beginRemoveRows(QModelIndex(), first, last);
+        m_rules.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+
+    // 4. Insert runs front to back; what is left already lines up with next
+    for (qsizetype first = head; first < newEnd; ) {
+        if (oldKeys.contains(next.at(first).key())) {
+            first++;
+            continue;
+        }
+        qsizetype last = first;
+        while (last + 1 < newEnd && !oldKeys.contains(next.at(last + 1).key())) last++;
+
+        beginInsertRows(QModelIndex(), first, last);
+        for (qsizetype i = first; i <= last; ++i) m_rules.insert(i, next.at(i));
+        endInsertRows();
+        first = last + 1;
+    }
+}
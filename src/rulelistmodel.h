@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+
+#include "portindex.h"
+#include "socketinventory.h"
+
+struct ZoneSettings;
+
+// Active rules of the viewed zone: services, ports, sources, then forwards.
+// setZone() diffs into row inserts and removals.
+class RuleListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        KindRole = Qt::UserRole + 1, // "service", "port", "source" or "forward"
+        ValueRole,                   // display text
+        PortRole,
+        ProtocolRole,
+        ToPortRole,
+        ToAddrRole,
+        SourceRole,
+        ListeningRole, // true / false, loopback-only sockets excluded; undefined for sources, remote forwards and unknown ports
+        ListenersRole, // "sshd (812), nginx (1020)"; always a string, for typed delegates
+    };
+    Q_ENUM(Roles)
+
+    explicit RuleListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setZone(const ZoneSettings &zone);
+    void setListeners(const SocketTablePtr &sockets, const PortIndex::ServicePorts &servicePorts);
+
+private:
+    struct Rule {
+        QString kind;
+        QString value;
+        QString port;
+        QString protocol;
+        QString toPort;
+        QString toAddr;
+        QString source;
+
+        // Unique within a zone; the value already carries every field
+        QString key() const { return kind + QLatin1Char('\n') + value; }
+        bool operator==(const Rule &other) const { return kind == other.kind && value == other.value; }
+    };
+
+    static QList<Rule> rulesFor(const ZoneSettings &zone);
+
+    // False when there is no telling for this rule
+    bool listenersFor(const Rule &rule, QList<Listener> &out) const;
+
+    QList<Rule> m_rules;
+    SocketTablePtr m_sockets; // null until the first scan
+    PortIndex::ServicePorts m_servicePorts;
+};
@@ -0,0 +1,278 @@
+#include "servicecatalog.h"
+#include "firewallconnection.h"
+#include "firewalld_interface.h"
+
+#include <QDBusArgument>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <numeric>
+
+// Enough to keep the bus busy without queueing hundreds of calls at once
+const int MAX_IN_FLIGHT = 16;
+
+static int protocolCode(const QString &protocol)
+{
+    if (protocol == "tcp") return 1;
+    if (protocol == "udp") return 2;
+    if (protocol == "sctp") return 3;
+    if (protocol == "dccp") return 4;
+    return 0;
+}
+
+static quint32 portKey(int port, int protocol)
+{
+    return quint32(port) << 3 | quint32(protocol);
+}
+
+ServiceCatalog::ServiceCatalog(FirewallConnection *bus, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_bus(bus)
+{
+}
+
+int ServiceCatalog::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int ServiceCatalog::count() const
+{
+    return m_rows.size();
+}
+
+QVariant ServiceCatalog::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid)) return QVariant();
+
+    const Service &service = m_services.at(m_rows.at(index.row()));
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole: return service.name;
+    case ShortNameRole: return service.shortName;
+    case DescriptionRole: return service.description;
+    case PortsRole: return portsOf(service.name);
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> ServiceCatalog::roleNames() const
+{
+    return {
+        {NameRole, "name"},
+        {ShortNameRole, "shortName"},
+        {DescriptionRole, "description"},
+        {PortsRole, "ports"},
+    };
+}
+
+QString ServiceCatalog::filter() const { return m_filter; }
+bool ServiceCatalog::loading() const { return m_loading; }
+
+void ServiceCatalog::setFilter(const QString &filter)
+{
+    if (m_filter == filter) return;
+    m_filter = filter;
+    emit filterChanged();
+    applyFilter();
+}
+
+void ServiceCatalog::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
+
+int ServiceCatalog::indexOf(const QString &name) const
+{
+    const QString key = name.toLower();
+    auto it = std::lower_bound(m_services.cbegin(), m_services.cend(), key,
+                               [](const Service &s, const QString &k) { return s.key < k; });
+    return it != m_services.cend() && it->key == key ? int(it - m_services.cbegin()) : -1;
+}
+
+// === LOADING ===
+
+void ServiceCatalog::setServices(const QStringList &names)
+{
+    QList<Service> next;
+    next.reserve(names.size());
+    m_queue.clear();
+
+    for (const QString &name : names) {
+        const int known = indexOf(name);
+        if (known >= 0 && m_services.at(known).loaded) {
+            next.append(m_services.at(known));
+            continue;
+        }
+
+        Service service;
+        service.name = name;
+        service.key = name.toLower();
+        next.append(service);
+        if (!m_unsupported && !m_fetching.contains(name)) m_queue.append(name);
+    }
+    std::sort(next.begin(), next.end(), [](const Service &a, const Service &b) { return a.key < b.key; });
+
+    m_services = next;
+    rebuildPortIndex();
+    applyFilter();
+
+    setLoading(!m_fetching.isEmpty() || !m_queue.isEmpty());
+    fetchNext();
+}
+
+void ServiceCatalog::fetchNext()
+{
+    while (m_fetching.size() < MAX_IN_FLIGHT && !m_queue.isEmpty()) {
+        const QString name = m_queue.takeFirst();
+        m_fetching.insert(name);
+
+        // Decoded on the worker; the nested ports tuple included
+        DBusCall call = DBusCall::main("getServiceSettings2", [name](auto *fw) { return fw->getServiceSettings2(name); });
+        call.decode = [](const QDBusMessage &reply) {
+            QVariantMap settings = qdbus_cast<QVariantMap>(reply.arguments().value(0));
+            settings.insert("ports", QVariant::fromValue(qdbus_cast<QList<ZonePort>>(settings.value("ports"))));
+            return QVariant(settings);
+        };
+
+        m_bus->call(call, [this, name](const DBusResult &reply) {
+            m_fetching.remove(name);
+
+            if (!reply.isError()) {
+                fetchFinished(name, reply.value.toMap());
+            } else if (reply.error.type() == QDBusError::UnknownMethod) {
+                // Names alone still work for picking a service
+                m_unsupported = true;
+                m_queue.clear();
+            }
+
+            if (!m_fetching.isEmpty() || !m_queue.isEmpty()) {
+                fetchNext();
+                return;
+            }
+
+            // All in: index once, then let port searches see the new data
+            rebuildPortIndex();
+            setLoading(false);
+            applyFilter();
+        });
+    }
+}
+
+void ServiceCatalog::fetchFinished(const QString &name, const QVariantMap &settings)
+{
+    const int i = indexOf(name);
+    if (i < 0) return; // dropped from the list meanwhile
+
+    Service &service = m_services[i];
+    service.shortName = settings.value("short").toString();
+    service.description = settings.value("description").toString();
+    service.ports = settings.value("ports").value<QList<ZonePort>>();
+    service.loaded = true;
+
+    const int row = m_rows.indexOf(i);
+    if (row >= 0) emit dataChanged(index(row), index(row));
+}
+
+// === INDEXES ===
+
+void ServiceCatalog::rebuildPortIndex()
+{
+    m_byPort.clear();
+    m_ranges.clear();
+
+    for (int i = 0; i < m_services.size(); ++i) {
+        for (const ZonePort &p : std::as_const(m_services.at(i).ports)) {
+            const int dash = p.port.indexOf('-');
+            const int first = p.port.left(dash < 0 ? p.port.size() : dash).toInt();
+            const int last = dash < 0 ? first : p.port.mid(dash + 1).toInt();
+            const int protocol = protocolCode(p.protocol);
+
+            if (first == last && protocol != 0) m_byPort[portKey(first, protocol)].append(i);
+            else m_ranges.append({first, last, p.protocol, i});
+        }
+    }
+}
+
+QStringList ServiceCatalog::servicesForPort(int port, const QString &protocol) const
+{
+    const QStringList protocols = protocol.isEmpty() ? QStringList{"tcp", "udp"} : QStringList{protocol.toLower()};
+
+    QList<int> hits;
+    for (const QString &proto : protocols) {
+        hits += m_byPort.value(portKey(port, protocolCode(proto)));
+        for (const PortRange &range : m_ranges) {
+            if (range.protocol == proto && port >= range.first && port <= range.last) hits.append(range.service);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end());
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+
+    QStringList names;
+    names.reserve(hits.size());
+    for (int i : std::as_const(hits)) names.append(m_services.at(i).name);
+    return names;
+}
+
+QList<ZonePort> ServiceCatalog::portsFor(const QString &service) const
+{
+    const int i = indexOf(service);
+    return i < 0 ? QList<ZonePort>() : m_services.at(i).ports;
+}
+
+QString ServiceCatalog::portsOf(const QString &service) const
+{
+    QStringList ports;
+    for (const ZonePort &p : portsFor(service)) ports.append(p.port + "/" + p.protocol);
+    return ports.join(", ");
+}
+
+// === FILTER ===
+
+void ServiceCatalog::applyFilter()
+{
+    static const QRegularExpression portQuery("^(\\d{1,5})(?:/([a-z]+))?$");
+
+    const QString query = m_filter.trimmed().toLower();
+    QList<int> rows;
+
+    if (query.isEmpty()) {
+        rows.resize(m_services.size());
+        std::iota(rows.begin(), rows.end(), 0);
+    } else {
+        QSet<int> seen;
+        auto add = [&rows, &seen](int i) {
+            if (!seen.contains(i)) {
+                seen.insert(i);
+                rows.append(i);
+            }
+        };
+
+        // 1. "5432" or "5432/tcp": straight from the port index
+        const QRegularExpressionMatch port = portQuery.match(query);
+        if (port.hasMatch()) {
+            for (const QString &name : servicesForPort(port.captured(1).toInt(), port.captured(2))) add(indexOf(name));
+        }
+
+        // 2. Name prefix: one binary search, the matches are contiguous
+        auto first = std::lower_bound(m_services.cbegin(), m_services.cend(), query,
+                                      [](const Service &s, const QString &q) { return s.key < q; });
+        for (auto it = first; it != m_services.cend() && it->key.startsWith(query); ++it) add(int(it - m_services.cbegin()));
+
+        // 3. Anywhere in the name or title, after the prefix hits
+        for (int i = 0; i < m_services.size(); ++i) {
+            const Service &s = m_services.at(i);
+            if (s.key.contains(query) || s.shortName.contains(query, Qt::CaseInsensitive)) add(i);
+        }
+    }
+
+    const int before = m_rows.size();
+    beginResetModel();
+    m_rows = rows;
+    endResetModel();
+    if (before != m_rows.size()) emit countChanged();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "zonesettings.h"
+
+class FirewallConnection;
+
+// Every service firewalld knows, with its ports. `filter` takes a name prefix
+// ("ssh") or a port ("5432", "5432/tcp").
+class ServiceCatalog : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        ShortNameRole,
+        DescriptionRole,
+        PortsRole, // "80/tcp, 443/tcp"
+    };
+    Q_ENUM(Roles)
+
+    explicit ServiceCatalog(FirewallConnection *bus, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString filter() const;
+    void setFilter(const QString &filter);
+    bool loading() const;
+    int count() const;
+
+    // Replaces the known names; details are only fetched for new ones
+    void setServices(const QStringList &names);
+
+    // Services opening the port, ranges included. No protocol means tcp or udp.
+    Q_INVOKABLE QStringList servicesForPort(int port, const QString &protocol = QString()) const;
+    Q_INVOKABLE QString portsOf(const QString &service) const;
+    QList<ZonePort> portsFor(const QString &service) const;
+
+signals:
+    void filterChanged();
+    void loadingChanged();
+    void countChanged();
+
+private:
+    struct Service {
+        QString name;
+        QString key; // lowercased name, what the prefix index is sorted by
+        QString shortName;
+        QString description;
+        QList<ZonePort> ports;
+        bool loaded = false;
+    };
+
+    struct PortRange {
+        int first = 0;
+        int last = 0;
+        QString protocol;
+        int service = 0;
+    };
+
+    int indexOf(const QString &name) const;
+    void fetchNext();
+    void fetchFinished(const QString &name, const QVariantMap &settings);
+    void rebuildPortIndex();
+    void applyFilter();
+    void setLoading(bool loading);
+
+    FirewallConnection *m_bus;
+    QList<Service> m_services;           // sorted by key
+    QHash<quint32, QList<int>> m_byPort; // portKey() -> services
+    QList<PortRange> m_ranges;           // "6000-6010" style entries, few enough to scan
+    QList<int> m_rows;                   // services matching the filter, in display order
+
+    QString m_filter;
+    QStringList m_queue;     // still waiting for details
+    QSet<QString> m_fetching; // sent, no reply yet
+    bool m_loading = false;
+    bool m_unsupported = false; // firewalld < 0.9 has no getServiceSettings2
+};
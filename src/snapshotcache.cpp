@@ -0,0 +1,92 @@
+#include "snapshotcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// Bump when the layout below changes; older files are then ignored
+const int CACHE_FORMAT = 2;
+
+static QString cacheFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/state.json";
+}
+
+QString SnapshotCache::configGeneration()
+{
+    static const char *const dirs[] = {
+        "/etc/firewalld",
+        "/etc/firewalld/zones",
+        "/etc/firewalld/services",
+        "/usr/lib/firewalld/zones",
+        "/usr/lib/firewalld/services",
+    };
+
+    QStringList parts;
+    for (const char *dir : dirs) {
+        const QFileInfo info(QString::fromLatin1(dir));
+        parts.append(info.exists() ? QString::number(info.lastModified().toMSecsSinceEpoch()) : "-");
+    }
+    return parts.join(':');
+}
+
+bool SnapshotCache::load(CachedState &state)
+{
+    QFile file(cacheFile());
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("format").toInt() != CACHE_FORMAT) return false;
+    if (root.value("configGeneration").toString() != configGeneration()) return false;
+
+    state.firewalldVersion = root.value("firewalldVersion").toString();
+    state.configGeneration = root.value("configGeneration").toString();
+    state.defaultZone = root.value("defaultZone").toString();
+    state.panic = root.value("panic").toBool();
+    state.logDenied = root.value("logDenied").toString("off");
+
+    const QJsonObject zones = root.value("zones").toObject();
+    for (auto it = zones.constBegin(); it != zones.constEnd(); ++it) {
+        state.zoneNames.append(it.key());
+        state.zones.insert(it.key(), ZoneSettings::fromJson(it.value().toObject()));
+    }
+
+    for (const QJsonValue &service : root.value("knownServices").toArray()) state.knownServices.append(service.toString());
+    return true;
+}
+
+void SnapshotCache::save(const CachedState &state)
+{
+    QJsonObject zones;
+    for (auto it = state.zones.constBegin(); it != state.zones.constEnd(); ++it) zones.insert(it.key(), it->toJson());
+
+    const QJsonObject root{
+        {"format", CACHE_FORMAT},
+        {"firewalldVersion", state.firewalldVersion},
+        {"configGeneration", state.configGeneration},
+        {"defaultZone", state.defaultZone},
+        {"panic", state.panic},
+        {"logDenied", state.logDenied},
+        {"zones", zones},
+        {"knownServices", QJsonArray::fromStringList(state.knownServices)},
+    };
+
+    const QString path = cacheFile();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // Written aside and renamed, so a crash never leaves half a cache behind
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+void SnapshotCache::discard()
+{
+    QFile::remove(cacheFile());
+}
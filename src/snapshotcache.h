@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "zonesettings.h"
+
+// State after the latest full refresh, shown on the next start until firewalld answers
+struct CachedState {
+    QString firewalldVersion;
+    QString configGeneration;
+    QString defaultZone;
+    bool panic = false;
+    QString logDenied = QStringLiteral("off");
+    QStringList zoneNames;
+    QHash<QString, ZoneSettings> zones;
+    QStringList knownServices;
+};
+
+namespace SnapshotCache {
+
+// mtimes of the zone and service directories; only stats, no bus
+QString configGeneration();
+
+// False if there is no cache or it is for another config generation
+bool load(CachedState &state);
+void save(const CachedState &state);
+void discard();
+
+}
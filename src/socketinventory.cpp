@@ -0,0 +1,424 @@
+#include "socketinventory.h"
+
+#include <QFile>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Kernel socket states (include/net/tcp_states.h). Unconnected UDP sockets sit in CLOSE.
+static constexpr int TCP_STATE_CLOSE = 7;
+static constexpr int TCP_STATE_LISTEN = 10;
+
+// === TABLE ===
+
+QList<Listener> SocketTable::listening(const QString &protocol, int first, int last) const
+{
+    const std::vector<Listener> *sockets = protocol == QLatin1String("tcp") ? &tcp
+                                         : protocol == QLatin1String("udp") ? &udp
+                                                                            : nullptr;
+    QList<Listener> out;
+    if (!sockets) return out;
+
+    auto it = std::lower_bound(sockets->begin(), sockets->end(), first,
+                               [](const Listener &l, int port) { return l.port < port; });
+    for (; it != sockets->end() && it->port <= last; ++it) out.append(*it);
+    return out;
+}
+
+bool SocketTable::covers(const QString &protocol)
+{
+    return protocol == QLatin1String("tcp") || protocol == QLatin1String("udp");
+}
+
+// === NETLINK ===
+
+namespace {
+
+class FileDescriptor
+{
+public:
+    explicit FileDescriptor(int fd) : m_fd(fd) {}
+    ~FileDescriptor() { if (m_fd >= 0) ::close(m_fd); }
+    FileDescriptor(const FileDescriptor &) = delete;
+    FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+    int get() const { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+}
+
+bool SocketScanner::readNetlink()
+{
+    FileDescriptor fd(::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG));
+    if (fd.get() < 0) return false;
+
+    struct Dump {
+        quint8 family;
+        quint8 protocol;
+        quint32 states;
+    };
+    static constexpr Dump dumps[] = {
+        {AF_INET, IPPROTO_TCP, 1u << TCP_STATE_LISTEN},
+        {AF_INET6, IPPROTO_TCP, 1u << TCP_STATE_LISTEN},
+        {AF_INET, IPPROTO_UDP, 1u << TCP_STATE_CLOSE},
+        {AF_INET6, IPPROTO_UDP, 1u << TCP_STATE_CLOSE},
+    };
+
+    alignas(nlmsghdr) char buffer[32768];
+
+    for (const Dump &dump : dumps) {
+        // The kernel filters by state, so only listeners cross into user space
+        struct {
+            nlmsghdr header;
+            inet_diag_req_v2 request;
+        } message{};
+        message.header.nlmsg_len = sizeof message;
+        message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+        message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        message.request.sdiag_family = dump.family;
+        message.request.sdiag_protocol = dump.protocol;
+        message.request.idiag_states = dump.states;
+
+        sockaddr_nl kernel{};
+        kernel.nl_family = AF_NETLINK;
+        if (::sendto(fd.get(), &message, sizeof message, 0, reinterpret_cast<sockaddr *>(&kernel), sizeof kernel) < 0)
+            return false;
+
+        for (bool done = false; !done; ) {
+            const ssize_t received = ::recv(fd.get(), buffer, sizeof buffer, 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) return false;
+
+            int left = int(received);
+            for (auto *header = reinterpret_cast<nlmsghdr *>(buffer); NLMSG_OK(header, left); header = NLMSG_NEXT(header, left)) {
+                if (header->nlmsg_type == NLMSG_DONE) {
+                    done = true;
+                    break;
+                }
+                if (header->nlmsg_type == NLMSG_ERROR) return false;
+                if (header->nlmsg_type != SOCK_DIAG_BY_FAMILY) continue;
+
+                const auto *diag = static_cast<const inet_diag_msg *>(NLMSG_DATA(header));
+                RawSocket raw;
+                raw.protocol = dump.protocol == IPPROTO_TCP ? Tcp : Udp;
+                raw.family = diag->idiag_family;
+                raw.port = ntohs(diag->id.idiag_sport);
+                raw.uid = diag->idiag_uid;
+                raw.inode = diag->idiag_inode;
+                std::memcpy(raw.address, diag->id.idiag_src, sizeof raw.address);
+                m_raw.push_back(raw);
+            }
+        }
+    }
+
+    return true;
+}
+
+// === /proc/net FALLBACK ===
+// "  0: 00000000:0016 00000000:0000 0A 00000000:00000000 00:00000000 00000000  0  0 12345 ..."
+
+static const char *nextField(const char *p, const char *end, const char **fieldEnd)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    const char *q = p;
+    while (q < end && *q != ' ' && *q != '\t' && *q != '\n') ++q;
+    *fieldEnd = q;
+    return p;
+}
+
+static bool parseHex(const char *p, const char *end, quint64 &out)
+{
+    if (p == end) return false;
+    out = 0;
+    for (; p < end; ++p) {
+        const char c = *p;
+        const int digit = c >= '0' && c <= '9' ? c - '0'
+                        : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                        : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                                               : -1;
+        if (digit < 0) return false;
+        out = out << 4 | quint64(digit);
+    }
+    return true;
+}
+
+static bool parseDecimal(const char *p, const char *end, quint64 &out)
+{
+    if (p == end) return false;
+    out = 0;
+    for (; p < end; ++p) {
+        if (*p < '0' || *p > '9') return false;
+        out = out * 10 + quint64(*p - '0');
+    }
+    return true;
+}
+
+bool SocketScanner::readProc()
+{
+    struct Table {
+        const char *path;
+        quint8 protocol;
+        quint8 family;
+        int state;
+    };
+    static constexpr Table tables[] = {
+        {"/proc/net/tcp", Tcp, AF_INET, TCP_STATE_LISTEN},
+        {"/proc/net/tcp6", Tcp, AF_INET6, TCP_STATE_LISTEN},
+        {"/proc/net/udp", Udp, AF_INET, TCP_STATE_CLOSE},
+        {"/proc/net/udp6", Udp, AF_INET6, TCP_STATE_CLOSE},
+    };
+
+    bool any = false;
+    char line[512];
+
+    for (const Table &table : tables) {
+        QFile file(QString::fromLatin1(table.path));
+        if (!file.open(QIODevice::ReadOnly)) continue; // no IPv6 on this host
+        any = true;
+
+        file.readLine(line, sizeof line); // header
+        for (qint64 length; (length = file.readLine(line, sizeof line)) > 0; ) {
+            const char *end = line + length;
+            const char *fieldEnd = nullptr;
+
+            nextField(line, end, &fieldEnd);                                // sl
+            const char *local = nextField(fieldEnd, end, &fieldEnd);        // address:port
+            const char *localEnd = fieldEnd;
+            nextField(fieldEnd, end, &fieldEnd);                            // remote
+            const char *state = nextField(fieldEnd, end, &fieldEnd);
+            const char *stateEnd = fieldEnd;
+
+            quint64 value = 0;
+            if (!parseHex(state, stateEnd, value) || int(value) != table.state) continue;
+
+            const char *colon = static_cast<const char *>(std::memchr(local, ':', localEnd - local));
+            const int words = table.family == AF_INET ? 1 : 4;
+            if (!colon || colon - local != words * 8) continue;
+
+            RawSocket raw{};
+            raw.protocol = table.protocol;
+            raw.family = table.family;
+
+            // Each 32-bit word is printed as the host reads it, so storing it back
+            // natively gives the bytes in network order again
+            bool ok = true;
+            for (int i = 0; i < words && ok; ++i) {
+                ok = parseHex(local + i * 8, local + i * 8 + 8, value);
+                raw.address[i] = quint32(value);
+            }
+            if (!ok || !parseHex(colon + 1, localEnd, value)) continue;
+            raw.port = quint16(value);
+
+            for (int skip = 0; skip < 3; ++skip) nextField(fieldEnd, end, &fieldEnd); // tx:rx, tr:when, retrnsmt
+            const char *uid = nextField(fieldEnd, end, &fieldEnd);
+            if (!parseDecimal(uid, fieldEnd, value)) continue;
+            raw.uid = quint32(value);
+            nextField(fieldEnd, end, &fieldEnd);                            // timeout
+            const char *inode = nextField(fieldEnd, end, &fieldEnd);
+            if (!parseDecimal(inode, fieldEnd, value)) continue;
+            raw.inode = value;
+
+            m_raw.push_back(raw);
+        }
+    }
+
+    return any;
+}
+
+// === OWNERS ===
+
+void SocketScanner::resolveOwners()
+{
+    // 1. Forget sockets that closed; keep what is known about the rest
+    QSet<quint64> current;
+    current.reserve(qsizetype(m_raw.size()));
+    for (const RawSocket &raw : m_raw) current.insert(raw.inode);
+
+    for (auto it = m_owners.begin(); it != m_owners.end(); ) {
+        if (current.contains(it.key())) ++it;
+        else it = m_owners.erase(it);
+    }
+
+    QSet<quint64> wanted;
+    for (quint64 inode : std::as_const(current)) {
+        if (!m_owners.contains(inode)) wanted.insert(inode);
+    }
+    if (wanted.isEmpty()) return;
+
+    // 2. One pass over /proc/<pid>/fd; other users' sockets stay unowned without root
+    if (DIR *proc = ::opendir("/proc")) {
+        char path[64];
+        char link[64];
+
+        while (!wanted.isEmpty()) {
+            const dirent *entry = ::readdir(proc);
+            if (!entry) break;
+            if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+
+            std::snprintf(path, sizeof path, "/proc/%s/fd", entry->d_name);
+            DIR *fds = ::opendir(path);
+            if (!fds) continue;
+
+            while (const dirent *fdEntry = ::readdir(fds)) {
+                if (fdEntry->d_name[0] == '.') continue;
+
+                const ssize_t length = ::readlinkat(::dirfd(fds), fdEntry->d_name, link, sizeof link - 1);
+                if (length < 10 || std::memcmp(link, "socket:[", 8) != 0) continue;
+                link[length] = '\0';
+
+                const quint64 inode = std::strtoull(link + 8, nullptr, 10);
+                if (!wanted.remove(inode)) continue;
+
+                Owner owner;
+                owner.pid = std::atoi(entry->d_name);
+
+                QFile comm(QStringLiteral("/proc/%1/comm").arg(owner.pid));
+                if (comm.open(QIODevice::ReadOnly)) owner.process = QString::fromUtf8(comm.readAll().trimmed());
+                m_owners.insert(inode, owner);
+            }
+            ::closedir(fds);
+        }
+        ::closedir(proc);
+    }
+
+    // 3. Not asked again until the socket closes
+    for (quint64 inode : std::as_const(wanted)) m_owners.insert(inode, Owner());
+}
+
+// === SCAN ===
+
+static quint64 mix(quint64 x)
+{
+    // splitmix64 finaliser
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static bool isLoopback(quint8 family, const quint32 *address)
+{
+    const auto *bytes = reinterpret_cast<const quint8 *>(address);
+    if (family == AF_INET) return bytes[0] == 127;
+
+    static const quint8 v6Loopback[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    static const quint8 v4Mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    return std::memcmp(bytes, v6Loopback, 16) == 0 || (std::memcmp(bytes, v4Mapped, 12) == 0 && bytes[12] == 127);
+}
+
+SocketTablePtr SocketScanner::buildTable() const
+{
+    auto table = QSharedPointer<SocketTable>::create();
+    char text[INET6_ADDRSTRLEN];
+
+    for (const RawSocket &raw : m_raw) {
+        Listener listener;
+        listener.port = raw.port;
+        listener.uid = raw.uid;
+        listener.inode = raw.inode;
+        listener.loopback = isLoopback(raw.family, raw.address);
+        if (::inet_ntop(raw.family, raw.address, text, sizeof text)) listener.address = QString::fromLatin1(text);
+
+        const Owner owner = m_owners.value(raw.inode);
+        listener.pid = owner.pid;
+        listener.process = owner.process;
+
+        (raw.protocol == Tcp ? table->tcp : table->udp).push_back(std::move(listener));
+    }
+
+    const auto byPort = [](const Listener &a, const Listener &b) { return a.port < b.port; };
+    std::sort(table->tcp.begin(), table->tcp.end(), byPort);
+    std::sort(table->udp.begin(), table->udp.end(), byPort);
+    return table;
+}
+
+void SocketScanner::scan()
+{
+    // 1. Raw sockets into the reused buffer
+    m_raw.clear();
+    if (m_useNetlink && !readNetlink()) {
+        m_useNetlink = false;
+        m_raw.clear();
+    }
+    if (!m_useNetlink && !readProc()) {
+        emit scanned(SocketTablePtr());
+        return;
+    }
+
+    // 2. Order-independent fingerprint; an unchanged set costs one pass and no allocation
+    quint64 fingerprint = m_raw.size();
+    for (const RawSocket &raw : m_raw)
+        fingerprint += mix(raw.inode ^ (quint64(raw.port) << 48) ^ (quint64(raw.protocol) << 40));
+
+    if (m_scanned && fingerprint == m_fingerprint) {
+        emit scanned(SocketTablePtr());
+        return;
+    }
+    m_scanned = true;
+    m_fingerprint = fingerprint;
+
+    // 3. Owners for new sockets only, then a fresh table
+    resolveOwners();
+    emit scanned(buildTable());
+}
+
+// === THREAD HANDOVER ===
+
+SocketInventory::SocketInventory(int intervalMs, QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<SocketTablePtr>();
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName(QStringLiteral("cinderward-sockets"));
+    m_scanner = new SocketScanner;
+    m_scanner->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_scanner, &QObject::deleteLater);
+
+    connect(m_scanner, &SocketScanner::scanned, this, [this](const SocketTablePtr &table) {
+        m_scanPending = false;
+        if (!table) return;
+        m_table = table;
+        emit changed();
+    });
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(intervalMs);
+    connect(m_timer, &QTimer::timeout, this, &SocketInventory::requestScan);
+
+    m_thread->start(QThread::LowPriority);
+    m_timer->start();
+    requestScan();
+}
+
+SocketInventory::~SocketInventory()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void SocketInventory::requestScan()
+{
+    if (m_scanPending) return;
+    m_scanPending = true;
+    QMetaObject::invokeMethod(m_scanner, &SocketScanner::scan, Qt::QueuedConnection);
+}
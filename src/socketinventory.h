@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+
+#include <vector>
+
+class QThread;
+class QTimer;
+
+// One socket waiting for traffic: a TCP listener or an unconnected UDP socket
+struct Listener {
+    quint16 port = 0;
+    QString address;       // "0.0.0.0", "::", "127.0.0.1"
+    bool loopback = false; // reachable from this host only
+    uint uid = 0;
+    quint64 inode = 0;
+    int pid = 0;           // 0 when the owner is hidden (another user's process, not root)
+    QString process;
+};
+
+// Every listening TCP and UDP socket, sorted by port; never modified once built
+struct SocketTable {
+    std::vector<Listener> tcp;
+    std::vector<Listener> udp;
+
+    // Listeners on any port in [first, last]
+    QList<Listener> listening(const QString &protocol, int first, int last) const;
+
+    // Only TCP and UDP are inventoried; for sctp, dccp and the rest there is no answer
+    static bool covers(const QString &protocol);
+};
+using SocketTablePtr = QSharedPointer<const SocketTable>;
+
+Q_DECLARE_METATYPE(SocketTablePtr)
+
+// Lives on SocketInventory's thread. sock_diag, or /proc/net when that is missing;
+// owners are looked up only for sockets not seen before.
+class SocketScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    void scan();
+
+signals:
+    // table is null when nothing changed since the last scan
+    void scanned(const SocketTablePtr &table);
+
+private:
+    enum Protocol : quint8 { Tcp, Udp };
+
+    // Plain data, so a scan that finds nothing new allocates nothing
+    struct RawSocket {
+        quint8 protocol;
+        quint8 family;
+        quint16 port;
+        quint32 uid;
+        quint64 inode;
+        quint32 address[4]; // network byte order, as the kernel reports it
+    };
+
+    struct Owner {
+        int pid = 0;
+        QString process;
+    };
+
+    bool readNetlink();
+    bool readProc();
+    void resolveOwners();
+    SocketTablePtr buildTable() const;
+
+    std::vector<RawSocket> m_raw; // reused between scans
+    bool m_useNetlink = true;     // off for good after the first failure
+    bool m_scanned = false;
+    quint64 m_fingerprint = 0;
+    QHash<quint64, Owner> m_owners; // by inode, sockets still listening only
+};
+
+// Listening sockets on this host, rescanned on a timer off the GUI thread.
+// changed() fires only when a socket appeared or went away.
+class SocketInventory : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SocketInventory(int intervalMs, QObject *parent = nullptr);
+    ~SocketInventory() override;
+
+    // Null until the first scan is in
+    SocketTablePtr table() const { return m_table; }
+
+signals:
+    void changed();
+
+private:
+    void requestScan();
+
+    QThread *m_thread = nullptr;
+    SocketScanner *m_scanner = nullptr;
+    QTimer *m_timer = nullptr;
+    bool m_scanPending = false; // a slow scan is skipped over, not queued behind
+    SocketTablePtr m_table;
+};
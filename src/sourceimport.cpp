@@ -0,0 +1,137 @@
+#include "sourceimport.h"
+
+#include <QTimer>
+
+#include <cstring>
+
+const qsizetype READ_BUFFER_SIZE = 256 * 1024;
+
+// Per event loop turn, so the window keeps painting during a big import
+const int SLICE_BUDGET_MS = 8;
+const int PROGRESS_INTERVAL_MS = 100;
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+SourceImport::SourceImport(const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_file(path)
+{
+}
+
+void SourceImport::start()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        emit finished(false, m_file.errorString());
+        return;
+    }
+
+    m_buffer.resize(READ_BUFFER_SIZE);
+    m_clock.start();
+    QTimer::singleShot(0, this, &SourceImport::readSlice);
+}
+
+QVariantMap SourceImport::stats() const
+{
+    const qint64 elapsed = qMax<qint64>(1, m_clock.elapsed());
+    return QVariantMap{
+        {"bytesRead", m_bytesRead},
+        {"bytesTotal", m_file.size()},
+        {"lines", m_lines},
+        {"accepted", m_accepted},
+        {"invalid", m_invalid},
+        {"firstInvalidLine", m_firstInvalidLine},
+        {"linesPerSecond", m_lines * 1000 / elapsed},
+    };
+}
+
+void SourceImport::readSlice()
+{
+    QElapsedTimer slice;
+    slice.start();
+
+    while (slice.elapsed() < SLICE_BUDGET_MS) {
+        char *data = m_buffer.data();
+        const qint64 read = m_file.read(data + m_carry, m_buffer.size() - m_carry);
+        if (read < 0) {
+            emit finished(false, m_file.errorString());
+            return;
+        }
+
+        const bool atEnd = read == 0;
+        m_bytesRead += read;
+        const qsizetype filled = m_carry + read;
+
+        // Every complete line in the buffer; the tail waits for the next read
+        const char *cursor = data;
+        const char *limit = data + filled;
+        while (const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', limit - cursor))) {
+            parseLine(cursor, newline);
+            cursor = newline + 1;
+        }
+
+        m_carry = limit - cursor;
+        if (atEnd) {
+            if (m_carry > 0) parseLine(cursor, limit);
+            m_carry = 0;
+            emit progress(stats());
+            emit finished(true, QString());
+            return;
+        }
+
+        if (m_carry == m_buffer.size()) {
+            emit finished(false, tr("Line %1 is too long").arg(m_lines + 1));
+            return;
+        }
+        std::memmove(data, cursor, m_carry);
+    }
+
+    if (m_clock.elapsed() - m_lastReportMs >= PROGRESS_INTERVAL_MS) {
+        m_lastReportMs = m_clock.elapsed();
+        emit progress(stats());
+    }
+    QTimer::singleShot(0, this, &SourceImport::readSlice);
+}
+
+void SourceImport::parseLine(const char *begin, const char *end)
+{
+    m_lines++;
+
+    // Strip comments and surrounding blanks; the first word is the address
+    while (begin < end && isSpace(*begin)) begin++;
+    const char *stop = begin;
+    while (stop < end && !isSpace(*stop) && *stop != '#' && *stop != ';') stop++;
+    if (stop == begin) return;
+
+    PrefixTrie::Prefix prefix;
+    if (!PrefixTrie::parse(begin, stop, prefix)) {
+        if (m_invalid++ == 0) m_firstInvalidLine = m_lines;
+        return;
+    }
+
+    m_accepted++;
+    if (prefix.family == PrefixTrie::IPv4) m_ipv4.insert(prefix);
+    else m_ipv6.insert(prefix);
+}
+
+// === D-BUS MARSHALLING ===
+
+QDBusArgument &operator<<(QDBusArgument &arg, const IPSetSettings &settings)
+{
+    arg.beginStructure();
+    arg << settings.version << settings.shortName << settings.description << settings.type
+        << settings.options << settings.entries;
+    arg.endStructure();
+    return arg;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &arg, IPSetSettings &settings)
+{
+    arg.beginStructure();
+    arg >> settings.version >> settings.shortName >> settings.description >> settings.type
+        >> settings.options >> settings.entries;
+    arg.endStructure();
+    return arg;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDBusArgument>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "prefixtrie.h"
+
+// Reads IPs / CIDRs, one per line ('#' and ';' start comments), into one PrefixTrie
+// per family, in slices between event loop turns
+class SourceImport : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SourceImport(const QString &path, QObject *parent = nullptr);
+
+    void start();
+
+    const PrefixTrie &ipv4() const { return m_ipv4; }
+    const PrefixTrie &ipv6() const { return m_ipv6; }
+
+    // bytesRead, bytesTotal, lines, accepted, invalid, linesPerSecond, firstInvalidLine
+    QVariantMap stats() const;
+
+signals:
+    void progress(const QVariantMap &stats);
+    void finished(bool ok, const QString &error);
+
+private:
+    void readSlice();
+    void parseLine(const char *begin, const char *end);
+
+    QFile m_file;
+    QByteArray m_buffer; // allocated once; a partial last line is carried to the front
+    qsizetype m_carry = 0;
+    QElapsedTimer m_clock;
+    qint64 m_lastReportMs = 0;
+
+    qint64 m_bytesRead = 0;
+    qint64 m_lines = 0;
+    qint64 m_accepted = 0;
+    qint64 m_invalid = 0;
+    qint64 m_firstInvalidLine = 0;
+
+    PrefixTrie m_ipv4{PrefixTrie::IPv4};
+    PrefixTrie m_ipv6{PrefixTrie::IPv6};
+};
+
+// Permanent ipset settings for config addIPSet, D-Bus signature (ssssa{ss}as)
+struct IPSetSettings {
+    QString version;
+    QString shortName;
+    QString description;
+    QString type;
+    QMap<QString, QString> options;
+    QStringList entries;
+};
+
+QDBusArgument &operator<<(QDBusArgument &arg, const IPSetSettings &settings);
+const QDBusArgument &operator>>(const QDBusArgument &arg, IPSetSettings &settings);
+
+Q_DECLARE_METATYPE(IPSetSettings)
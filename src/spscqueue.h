@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded single-producer / single-consumer ring; neither side blocks or locks
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // False when full; the item is left untouched
+    bool push(T &&item)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) return false;
+
+        m_slots[tail & (Capacity - 1)] = std::move(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // False when empty
+    bool pop(T &out)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+        T &slot = m_slots[head & (Capacity - 1)];
+        out = std::move(slot);
+        slot = T(); // don't keep the moved-from payload's resources alive
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Apart, so the two threads don't bounce one cache line between them
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    std::array<T, Capacity> m_slots;
+};
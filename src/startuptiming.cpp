@@ -0,0 +1,23 @@
+#include "startuptiming.h"
+
+#include <QElapsedTimer>
+
+Q_LOGGING_CATEGORY(lcStartup, "cinderward.startup", QtWarningMsg)
+
+static QElapsedTimer s_clock;
+static qint64 s_lastMs = 0;
+
+void StartupTiming::start()
+{
+    s_clock.start();
+    s_lastMs = 0;
+}
+
+void StartupTiming::mark(const char *phase)
+{
+    if (!s_clock.isValid()) return;
+
+    const qint64 now = s_clock.elapsed();
+    qCInfo(lcStartup, "%6lld ms  (+%lld ms)  %s", now, now - s_lastMs, phase);
+    s_lastMs = now;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(lcStartup)
+
+// Time-to-first-frame breakdown, off by default; enable with
+//     QT_LOGGING_RULES="cinderward.startup.info=true"
+namespace StartupTiming {
+
+void start();
+void mark(const char *phase);
+
+}
@@ -0,0 +1,86 @@
+#include "writescheduler.h"
+
+#include <QTimer>
+
+static QString writeId(const QString &lane, const QString &key)
+{
+    return lane + QLatin1Char('\n') + key;
+}
+
+WriteScheduler::WriteScheduler(int debounceMs, QObject *parent)
+    : QObject(parent)
+    , m_debounceMs(debounceMs)
+{
+}
+
+void WriteScheduler::schedule(const QString &lane, const QString &key, const Operation &op)
+{
+    const QString id = writeId(lane, key);
+    if (!m_waiting.contains(id)) m_lanes[lane].waiting++;
+    m_waiting.insert(id, op);
+
+    QTimer *&timer = m_timers[id];
+    if (!timer) {
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        timer->setInterval(m_debounceMs);
+        connect(timer, &QTimer::timeout, this, [this, lane, key]() { release(lane, key); });
+    }
+
+    // Every newer state restarts the window
+    timer->start();
+}
+
+bool WriteScheduler::isIdle(const QString &lane) const
+{
+    return !m_lanes.contains(lane);
+}
+
+void WriteScheduler::release(const QString &lane, const QString &key)
+{
+    auto it = m_waiting.find(writeId(lane, key));
+    if (it == m_waiting.end()) return;
+
+    const Operation op = it.value();
+    m_waiting.erase(it);
+
+    Lane &l = m_lanes[lane];
+    l.waiting--;
+
+    // A queued write for the same key that hasn't started yet is superseded
+    for (auto &entry : l.ready) {
+        if (entry.first == key) {
+            entry.second = op;
+            pump(lane);
+            return;
+        }
+    }
+
+    l.ready.append({key, op});
+    pump(lane);
+}
+
+void WriteScheduler::pump(const QString &lane)
+{
+    Lane &l = m_lanes[lane];
+    if (l.inFlight) return;
+
+    if (l.ready.isEmpty()) {
+        if (l.waiting == 0) {
+            m_lanes.remove(lane);
+            emit idle(lane);
+        }
+        return;
+    }
+
+    const QPair<QString, Operation> next = l.ready.takeFirst();
+    l.inFlight = true;
+
+    // The operation may finish synchronously, so `l` is not touched past this point
+    const QString key = next.first;
+    next.second([this, lane, key](bool ok) {
+        m_lanes[lane].inFlight = false;
+        if (!ok) emit failed(lane, key);
+        pump(lane);
+    });
+}
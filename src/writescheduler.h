@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QString>
+
+#include <functional>
+
+class QTimer;
+
+// Latest-wins writes keyed by (lane, key); lane is a zone, "" for global switches.
+// Each lane runs one write at a time.
+class WriteScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Done = std::function<void(bool ok)>;
+    using Operation = std::function<void(const Done &done)>;
+
+    explicit WriteScheduler(int debounceMs, QObject *parent = nullptr);
+
+    void schedule(const QString &lane, const QString &key, const Operation &op);
+
+    // Nothing waiting, queued or in flight for the lane
+    bool isIdle(const QString &lane) const;
+
+signals:
+    void failed(const QString &lane, const QString &key);
+    void idle(const QString &lane);
+
+private:
+    struct Lane {
+        QList<QPair<QString, Operation>> ready; // past the window, in order
+        int waiting = 0;                        // keys still inside the window
+        bool inFlight = false;
+    };
+
+    void release(const QString &lane, const QString &key);
+    void pump(const QString &lane);
+
+    int m_debounceMs;
+    QHash<QString, Lane> m_lanes;
+    QHash<QString, Operation> m_waiting; // by lane + key
+    QHash<QString, QTimer *> m_timers;   // by lane + key
+};
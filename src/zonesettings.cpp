@@ -0,0 +1,214 @@
+#include "zonesettings.h"
+
+#include <QDBusMetaType>
+#include <QJsonArray>
+
+// === D-BUS MARSHALLING ===
+
+QDBusArgument &operator<<(QDBusArgument &arg, const ZonePort &port)
+{
+    arg.beginStructure();
+    arg << port.port << port.protocol;
+    arg.endStructure();
+    return arg;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &arg, ZonePort &port)
+{
+    arg.beginStructure();
+    arg >> port.port >> port.protocol;
+    arg.endStructure();
+    return arg;
+}
+
+QDBusArgument &operator<<(QDBusArgument &arg, const ForwardPort &forward)
+{
+    arg.beginStructure();
+    arg << forward.port << forward.protocol << forward.toPort << forward.toAddr;
+    arg.endStructure();
+    return arg;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &arg, ForwardPort &forward)
+{
+    arg.beginStructure();
+    arg >> forward.port >> forward.protocol >> forward.toPort >> forward.toAddr;
+    arg.endStructure();
+    return arg;
+}
+
+void registerZoneSettingsTypes()
+{
+    // Called from the GUI and worker threads; a magic static runs this once
+    static const bool registered = [] {
+        qDBusRegisterMetaType<ZonePort>();
+        qDBusRegisterMetaType<QList<ZonePort>>();
+        qDBusRegisterMetaType<ForwardPort>();
+        qDBusRegisterMetaType<QList<ForwardPort>>();
+        return true;
+    }();
+    Q_UNUSED(registered)
+}
+
+// === DECODING ===
+
+ZoneSettings ZoneSettings::fromVariantMap(const QVariantMap &map)
+{
+    ZoneSettings s;
+
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        const QString &key = it.key();
+        const QVariant &value = it.value();
+
+        if (key == "version") s.version = value.toString();
+        else if (key == "short") s.shortName = value.toString();
+        else if (key == "description") s.description = value.toString();
+        else if (key == "target") s.target = value.toString();
+        else if (key == "services") s.services = qdbus_cast<QStringList>(value);
+        else if (key == "ports") s.ports = qdbus_cast<QList<ZonePort>>(value);
+        else if (key == "icmp_blocks") s.icmpBlocks = qdbus_cast<QStringList>(value);
+        else if (key == "masquerade") s.masquerade = value.toBool();
+        else if (key == "forward_ports") s.forwardPorts = qdbus_cast<QList<ForwardPort>>(value);
+        else if (key == "interfaces") s.interfaces = qdbus_cast<QStringList>(value);
+        else if (key == "sources") s.sources = qdbus_cast<QStringList>(value);
+        else if (key == "rules_str") s.richRules = qdbus_cast<QStringList>(value);
+        else if (key == "protocols") s.protocols = qdbus_cast<QStringList>(value);
+        else if (key == "source_ports") s.sourcePorts = qdbus_cast<QList<ZonePort>>(value);
+        else if (key == "icmp_block_inversion") s.icmpBlockInversion = value.toBool();
+    }
+
+    return s;
+}
+
+ZoneSettings ZoneSettings::fromLegacyArgument(const QDBusArgument &arg)
+{
+    ZoneSettings s;
+    bool unused = false;
+
+    arg.beginStructure();
+    arg >> s.version >> s.shortName >> s.description >> unused >> s.target
+        >> s.services >> s.ports >> s.icmpBlocks >> s.masquerade >> s.forwardPorts
+        >> s.interfaces >> s.sources >> s.richRules >> s.protocols >> s.sourcePorts
+        >> s.icmpBlockInversion;
+    arg.endStructure();
+
+    return s;
+}
+
+// === ENCODING ===
+
+QVariantMap ZoneSettings::deltaFrom(const ZoneSettings &base) const
+{
+    QVariantMap delta;
+
+    if (shortName != base.shortName) delta.insert("short", shortName);
+    if (description != base.description) delta.insert("description", description);
+    if (target != base.target) delta.insert("target", target);
+    if (services != base.services) delta.insert("services", services);
+    if (ports != base.ports) delta.insert("ports", QVariant::fromValue(ports));
+    if (icmpBlocks != base.icmpBlocks) delta.insert("icmp_blocks", icmpBlocks);
+    if (masquerade != base.masquerade) delta.insert("masquerade", masquerade);
+    if (forwardPorts != base.forwardPorts) delta.insert("forward_ports", QVariant::fromValue(forwardPorts));
+    if (interfaces != base.interfaces) delta.insert("interfaces", interfaces);
+    if (sources != base.sources) delta.insert("sources", sources);
+    if (richRules != base.richRules) delta.insert("rules_str", richRules);
+    if (protocols != base.protocols) delta.insert("protocols", protocols);
+    if (sourcePorts != base.sourcePorts) delta.insert("source_ports", QVariant::fromValue(sourcePorts));
+    if (icmpBlockInversion != base.icmpBlockInversion) delta.insert("icmp_block_inversion", icmpBlockInversion);
+
+    return delta;
+}
+
+bool ZoneSettings::operator==(const ZoneSettings &other) const
+{
+    return version == other.version
+        && shortName == other.shortName
+        && description == other.description
+        && target == other.target
+        && services == other.services
+        && ports == other.ports
+        && icmpBlocks == other.icmpBlocks
+        && masquerade == other.masquerade
+        && forwardPorts == other.forwardPorts
+        && interfaces == other.interfaces
+        && sources == other.sources
+        && richRules == other.richRules
+        && protocols == other.protocols
+        && sourcePorts == other.sourcePorts
+        && icmpBlockInversion == other.icmpBlockInversion;
+}
+
+// === JSON ===
+
+static QJsonArray portsToJson(const QList<ZonePort> &ports)
+{
+    QJsonArray array;
+    for (const ZonePort &p : ports) array.append(QJsonArray{p.port, p.protocol});
+    return array;
+}
+
+static QList<ZonePort> portsFromJson(const QJsonArray &array)
+{
+    QList<ZonePort> ports;
+    ports.reserve(array.size());
+    for (const QJsonValue &value : array) {
+        const QJsonArray entry = value.toArray();
+        ports.append({entry.at(0).toString(), entry.at(1).toString()});
+    }
+    return ports;
+}
+
+static QStringList stringsFromJson(const QJsonValue &value)
+{
+    QStringList list;
+    for (const QJsonValue &entry : value.toArray()) list.append(entry.toString());
+    return list;
+}
+
+QJsonObject ZoneSettings::toJson() const
+{
+    QJsonArray forwards;
+    for (const ForwardPort &f : forwardPorts) forwards.append(QJsonArray{f.port, f.protocol, f.toPort, f.toAddr});
+
+    return QJsonObject{
+        {"version", version},
+        {"short", shortName},
+        {"description", description},
+        {"target", target},
+        {"services", QJsonArray::fromStringList(services)},
+        {"ports", portsToJson(ports)},
+        {"icmp_blocks", QJsonArray::fromStringList(icmpBlocks)},
+        {"masquerade", masquerade},
+        {"forward_ports", forwards},
+        {"interfaces", QJsonArray::fromStringList(interfaces)},
+        {"sources", QJsonArray::fromStringList(sources)},
+        {"rules_str", QJsonArray::fromStringList(richRules)},
+        {"protocols", QJsonArray::fromStringList(protocols)},
+        {"source_ports", portsToJson(sourcePorts)},
+        {"icmp_block_inversion", icmpBlockInversion},
+    };
+}
+
+ZoneSettings ZoneSettings::fromJson(const QJsonObject &json)
+{
+    ZoneSettings s;
+    s.version = json.value("version").toString();
+    s.shortName = json.value("short").toString();
+    s.description = json.value("description").toString();
+    s.target = json.value("target").toString(s.target);
+    s.services = stringsFromJson(json.value("services"));
+    s.ports = portsFromJson(json.value("ports").toArray());
+    s.icmpBlocks = stringsFromJson(json.value("icmp_blocks"));
+    s.masquerade = json.value("masquerade").toBool();
+    for (const QJsonValue &value : json.value("forward_ports").toArray()) {
+        const QJsonArray f = value.toArray();
+        s.forwardPorts.append({f.at(0).toString(), f.at(1).toString(), f.at(2).toString(), f.at(3).toString()});
+    }
+    s.interfaces = stringsFromJson(json.value("interfaces"));
+    s.sources = stringsFromJson(json.value("sources"));
+    s.richRules = stringsFromJson(json.value("rules_str"));
+    s.protocols = stringsFromJson(json.value("protocols"));
+    s.sourcePorts = portsFromJson(json.value("source_ports").toArray());
+    s.icmpBlockInversion = json.value("icmp_block_inversion").toBool();
+    return s;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QDBusArgument>
+#include <QJsonObject>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <tuple>
+
+// (port, protocol) as used by ports and source-ports, D-Bus signature (ss)
+struct ZonePort {
+    QString port;
+    QString protocol;
+
+    bool operator==(const ZonePort &other) const
+    {
+        return port == other.port && protocol == other.protocol;
+    }
+    bool operator!=(const ZonePort &other) const { return !(*this == other); }
+    bool operator<(const ZonePort &other) const { return std::tie(port, protocol) < std::tie(other.port, other.protocol); }
+};
+
+// (port, protocol, toport, toaddr), D-Bus signature (ssss)
+struct ForwardPort {
+    QString port;
+    QString protocol;
+    QString toPort;
+    QString toAddr;
+
+    bool operator==(const ForwardPort &other) const
+    {
+        return port == other.port && protocol == other.protocol
+            && toPort == other.toPort && toAddr == other.toAddr;
+    }
+    bool operator!=(const ForwardPort &other) const { return !(*this == other); }
+    bool operator<(const ForwardPort &other) const
+    {
+        return std::tie(port, protocol, toPort, toAddr) < std::tie(other.port, other.protocol, other.toPort, other.toAddr);
+    }
+};
+
+// Permanent configuration of one zone, decoded from config.zone getSettings2 (a{sv}).
+// Keys firewalld leaves out of the dictionary keep the defaults below.
+struct ZoneSettings {
+    QString version;
+    QString shortName;
+    QString description;
+    QString target = QStringLiteral("default");
+    QStringList services;
+    QList<ZonePort> ports;
+    QStringList icmpBlocks;
+    bool masquerade = false;
+    QList<ForwardPort> forwardPorts;
+    QStringList interfaces;
+    QStringList sources;
+    QStringList richRules;
+    QStringList protocols;
+    QList<ZonePort> sourcePorts;
+    bool icmpBlockInversion = false;
+
+    static ZoneSettings fromVariantMap(const QVariantMap &map);
+
+    // Pre-0.9 firewalld only has getSettings, a (sssbsasa(ss)asba(ssss)asasasasa(ss)b) tuple
+    static ZoneSettings fromLegacyArgument(const QDBusArgument &arg);
+
+    // Only the keys that differ from base, ready for config.zone update2,
+    // which leaves every key it isn't given untouched.
+    QVariantMap deltaFrom(const ZoneSettings &base) const;
+
+    // Plain JSON with the getSettings2 key names, for the on-disk startup cache
+    QJsonObject toJson() const;
+    static ZoneSettings fromJson(const QJsonObject &json);
+
+    bool operator==(const ZoneSettings &other) const;
+    bool operator!=(const ZoneSettings &other) const { return !(*this == other); }
+};
+
+QDBusArgument &operator<<(QDBusArgument &arg, const ZonePort &port);
+const QDBusArgument &operator>>(const QDBusArgument &arg, ZonePort &port);
+QDBusArgument &operator<<(QDBusArgument &arg, const ForwardPort &forward);
+const QDBusArgument &operator>>(const QDBusArgument &arg, ForwardPort &forward);
+
+Q_DECLARE_METATYPE(ZonePort)
+Q_DECLARE_METATYPE(ForwardPort)
+Q_DECLARE_METATYPE(ZoneSettings)
+
+// Registers the tuple types with QtDBus. Safe to call more than once.
+void registerZoneSettingsTypes();
@@ -0,0 +1,434 @@
+// The backend against a mock firewalld on a private bus
+//
+//     ctest -R backendbenchmark --verbose
+//     ./backendbenchmark -median 5 refresh
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QTest>
+#include <QThread>
+#include <QTimer>
+
+#include <QUrl>
+
+#include <functional>
+#include <memory>
+
+#include "deniedlog.h"
+#include "firewallbackend.h"
+#include "firewallconnection.h"
+#include "mockfirewalld.h"
+#include "rulelistmodel.h"
+#include "zonesettings.h"
+
+const QString BENCH_ZONE = "public";
+const int BATCH_EDITS = 50;
+const int WAIT_TIMEOUT_MS = 120000;
+const int LOG_LINES = 100000;
+
+// Spins the event loop until `done` holds, checking each time `sender` emits `signal`
+template <typename Sender, typename Signal>
+static bool waitUntil(const Sender *sender, Signal signal, const std::function<bool()> &done)
+{
+    if (done()) return true;
+
+    QEventLoop loop;
+    QObject::connect(sender, signal, &loop, [&loop, &done]() {
+        if (done()) loop.quit();
+    });
+    QTimer::singleShot(WAIT_TIMEOUT_MS, &loop, &QEventLoop::quit);
+    loop.exec();
+    return done();
+}
+
+// `count` distinct ports; the protocols keep them unique past 65535
+static ZoneSettings zoneWithPorts(int count, const QString &low = "tcp", const QString &high = "udp")
+{
+    ZoneSettings zone;
+    zone.ports.reserve(count);
+    for (int i = 0; i < count; ++i) zone.ports.append({QString::number(1 + i % 60000), i < 60000 ? low : high});
+    return zone;
+}
+
+// `count` addresses, every other one, so the trie has nothing to fold
+static QByteArray sourceListText(int count, int first = 0)
+{
+    QByteArray text;
+    text.reserve(count * 16);
+    for (int i = first; i < first + count; ++i) {
+        const int host = 2 * i;
+        text += "10." + QByteArray::number(host >> 16 & 255) + "." + QByteArray::number(host >> 8 & 255) + "."
+            + QByteArray::number(host & 255) + "\n";
+    }
+    return text;
+}
+
+// `lines` kernel log lines from `sources` distinct addresses; every tenth line
+// is some other kernel message the tokenizer has to skip
+static QByteArray deniedLogText(int lines, int sources)
+{
+    QByteArray text;
+    text.reserve(lines * 200);
+    for (int i = 0; i < lines; ++i) {
+        if (i % 10 == 9) {
+            text += "6," + QByteArray::number(i) + ",1000,-;usb 1-1: new high-speed USB device number 3 using xhci_hcd\n";
+            continue;
+        }
+        const int source = i % sources;
+        text += "4," + QByteArray::number(i) + ",1000,-;filter_IN_public_REJECT: IN=eth0 OUT= MAC=52:54:00:12:34:56 "
+                "SRC=10." + QByteArray::number(source >> 16 & 255) + "." + QByteArray::number(source >> 8 & 255) + "."
+                + QByteArray::number(source & 255) + " DST=192.0.2.1 LEN=60 TOS=0x00 PREC=0x00 TTL=64 ID=4242 DF "
+                "PROTO=TCP SPT=40000 DPT=" + QByteArray::number(1 + i % 1024) + " WINDOW=64240 RES=0x00 SYN URGP=0\n";
+    }
+    return text;
+}
+
+static void addRuleCounts()
+{
+    QTest::addColumn<int>("rules");
+    QTest::newRow("10 rules") << 10;
+    QTest::newRow("1k rules") << 1000;
+    QTest::newRow("100k rules") << 100000;
+}
+
+class BackendBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Every zone read, from refresh() to the model showing it
+    void refresh_data();
+    void refresh();
+
+    // One addPort() until firewalld has it permanently, debounce included
+    void mutation_data();
+    void mutation();
+
+    // BATCH_EDITS staged edits, one update2 and one reload
+    void batchApply_data();
+    void batchApply();
+
+    // RuleListModel::setZone() alone, for one changed rule and for all of them
+    void modelUpdate_data();
+    void modelUpdate();
+
+    // A slow daemon must never show up on the calling thread
+    void slowDaemonDoesNotBlock();
+
+    // A source list into a new ipset, from reading the file to the reload
+    void importSources_data();
+    void importSources();
+    // A second list into the same set only adds what it lacks
+    void importExtendsExistingSet();
+
+    // LOG_LINES kernel log lines through the tokenizer, ring and top-N summaries
+    void deniedLogIngest_data();
+    void deniedLogIngest();
+
+private:
+    bool loadRules(int count);
+    QVariantMap importList(const QByteArray &text, const QString &ipset, qsizetype *uploadedSeen = nullptr);
+
+    QProcess m_daemon;
+    QThread m_mockThread;
+    MockFirewallD *m_mock = nullptr;
+    FirewallBackend *m_backend = nullptr;
+
+    int m_batchesFinished = 0;
+    QVariantMap m_lastBatch;
+    int m_nextPort = 0; // unique per added port across the whole run
+    int m_nextIPSet = 0;
+};
+
+void BackendBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    // 1. A private bus nobody else is on
+    const QString daemon = QStandardPaths::findExecutable("dbus-daemon");
+    if (daemon.isEmpty()) QSKIP("dbus-daemon not found");
+
+    m_daemon.start(daemon, {"--session", "--nofork", "--print-address"});
+    QVERIFY2(m_daemon.waitForStarted(), qPrintable(m_daemon.errorString()));
+    QVERIFY(m_daemon.waitForReadyRead(10000));
+    const QString address = QString::fromUtf8(m_daemon.readLine()).trimmed();
+    QVERIFY(!address.isEmpty());
+
+    // 2. firewalld on its own thread, as it would be in its own process
+    m_mock = new MockFirewallD;
+    m_mock->moveToThread(&m_mockThread);
+    connect(&m_mockThread, &QThread::finished, m_mock, &QObject::deleteLater);
+    m_mockThread.start();
+
+    bool started = false;
+    QMetaObject::invokeMethod(m_mock, [this, address, &started]() { started = m_mock->start(address); },
+                              Qt::BlockingQueuedConnection);
+    QVERIFY(started);
+
+    // 3. The backend under test, pointed at it
+    m_backend = new FirewallBackend(new FirewallConnection(address), this);
+    connect(m_backend, &FirewallBackend::batchFinished, this, [this](const QVariantMap &result) {
+        m_lastBatch = result;
+        m_batchesFinished++;
+    });
+}
+
+void BackendBenchmark::cleanupTestCase()
+{
+    delete m_backend;
+    m_backend = nullptr;
+
+    m_mockThread.quit();
+    m_mockThread.wait();
+
+    m_daemon.terminate();
+    m_daemon.waitForFinished();
+}
+
+// Puts `count` ports in the benchmark zone, next to a few small ones, and
+// waits for the backend to show them
+bool BackendBenchmark::loadRules(int count)
+{
+    ZoneSettings home;
+    home.services = QStringList{"ssh", "mdns"};
+    ZoneSettings trusted;
+    trusted.target = "ACCEPT";
+    ZoneSettings block;
+    block.target = "%%REJECT%%";
+
+    m_mock->setDelay(0);
+    m_mock->setZones({{BENCH_ZONE, zoneWithPorts(count)}, {"home", home}, {"trusted", trusted}, {"block", block}},
+                     BENCH_ZONE);
+
+    m_backend->refresh(BENCH_ZONE);
+    return waitUntil(m_backend, &FirewallBackend::busyChanged, [this]() { return !m_backend->busy(); })
+        && m_backend->rules()->rowCount() == count;
+}
+
+void BackendBenchmark::refresh_data()
+{
+    addRuleCounts();
+}
+
+void BackendBenchmark::refresh()
+{
+    QFETCH(int, rules);
+    QVERIFY(loadRules(rules));
+
+    QBENCHMARK {
+        m_backend->refresh(BENCH_ZONE);
+        QVERIFY(waitUntil(m_backend, &FirewallBackend::busyChanged, [this]() { return !m_backend->busy(); }));
+    }
+
+    QCOMPARE(m_backend->rules()->rowCount(), rules);
+}
+
+void BackendBenchmark::mutation_data()
+{
+    addRuleCounts();
+}
+
+void BackendBenchmark::mutation()
+{
+    QFETCH(int, rules);
+    QVERIFY(loadRules(rules));
+
+    QBENCHMARK {
+        const ZonePort entry{QString::number(++m_nextPort), "sctp"};
+        m_backend->addPort(entry.port, entry.protocol, BENCH_ZONE);
+        QVERIFY(waitUntil(m_mock, &MockFirewallD::permanentChanged, [this, entry]() {
+            return m_mock->permanentZone(BENCH_ZONE).ports.contains(entry);
+        }));
+    }
+}
+
+void BackendBenchmark::batchApply_data()
+{
+    addRuleCounts();
+}
+
+void BackendBenchmark::batchApply()
+{
+    QFETCH(int, rules);
+    QVERIFY(loadRules(rules));
+
+    QBENCHMARK {
+        const int before = m_batchesFinished;
+
+        QVERIFY(m_backend->beginBatch());
+        for (int i = 0; i < BATCH_EDITS; ++i) m_backend->addPort(QString::number(++m_nextPort), "sctp", BENCH_ZONE);
+        QVERIFY(m_backend->commitBatch());
+
+        QVERIFY(waitUntil(m_backend, &FirewallBackend::batchFinished, [this, before]() {
+            return m_batchesFinished > before;
+        }));
+        const QString firstError = m_lastBatch.value("errors").toList().value(0).toMap().value("message").toString();
+        QVERIFY2(m_lastBatch.value("ok").toBool(), qPrintable(firstError));
+    }
+}
+
+void BackendBenchmark::modelUpdate_data()
+{
+    QTest::addColumn<int>("rules");
+    QTest::addColumn<bool>("replaceAll");
+
+    for (int rules : {10, 1000, 100000}) {
+        QTest::addRow("%d rules, one changed", rules) << rules << false;
+        QTest::addRow("%d rules, all replaced", rules) << rules << true;
+    }
+}
+
+void BackendBenchmark::modelUpdate()
+{
+    QFETCH(int, rules);
+    QFETCH(bool, replaceAll);
+
+    const ZoneSettings first = zoneWithPorts(rules);
+    ZoneSettings second = replaceAll ? zoneWithPorts(rules, "dccp", "sctp") : first;
+    if (!replaceAll) second.ports[rules / 2] = ZonePort{"1", "sctp"};
+
+    RuleListModel model;
+    model.setZone(first);
+
+    bool flip = false;
+    QBENCHMARK {
+        flip = !flip;
+        model.setZone(flip ? second : first);
+    }
+
+    QCOMPARE(model.rowCount(), rules);
+}
+
+void BackendBenchmark::slowDaemonDoesNotBlock()
+{
+    QVERIFY(loadRules(1000));
+    m_mock->setDelay(500);
+
+    const ZonePort entry{QString::number(++m_nextPort), "sctp"};
+
+    QElapsedTimer timer;
+    timer.start();
+    m_backend->refresh(BENCH_ZONE);
+    m_backend->addPort(entry.port, entry.protocol, BENCH_ZONE);
+    m_backend->setMasquerade(true, BENCH_ZONE);
+    const qint64 elapsed = timer.elapsed();
+
+    QVERIFY2(elapsed < 100, qPrintable(QStringLiteral("calls took %1 ms against a 500 ms daemon").arg(elapsed)));
+
+    // The edit still lands, just late
+    QVERIFY(waitUntil(m_mock, &MockFirewallD::permanentChanged, [this, entry]() {
+        return m_mock->permanentZone(BENCH_ZONE).ports.contains(entry);
+    }));
+    m_mock->setDelay(0);
+}
+
+// Imports `text` into `ipset` and returns importFinished's result
+QVariantMap BackendBenchmark::importList(const QByteArray &text, const QString &ipset, qsizetype *uploadedSeen)
+{
+    QTemporaryFile file;
+    if (!file.open() || file.write(text) != text.size()) return {};
+    file.flush();
+
+    QVariantMap result;
+    bool finished = false;
+    QObject context;
+    connect(m_backend, &FirewallBackend::importFinished, &context, [&](const QVariantMap &r) {
+        result = r;
+        finished = true;
+    });
+    connect(m_backend, &FirewallBackend::importProgress, &context, [uploadedSeen](const QVariantMap &progress) {
+        if (uploadedSeen && progress.value("stage") == "uploading") *uploadedSeen = progress.value("uploaded").toLongLong();
+    });
+
+    if (!m_backend->importSources(QUrl::fromLocalFile(file.fileName()), ipset, BENCH_ZONE)) return {};
+    waitUntil(m_backend, &FirewallBackend::importFinished, [&finished]() { return finished; });
+    return result;
+}
+
+void BackendBenchmark::importSources_data()
+{
+    QTest::addColumn<int>("addresses");
+    QTest::newRow("1k addresses") << 1000;
+    QTest::newRow("100k addresses") << 100000;
+}
+
+void BackendBenchmark::importSources()
+{
+    QFETCH(int, addresses);
+    QVERIFY(loadRules(10));
+
+    const QByteArray text = sourceListText(addresses);
+    QString ipset;
+    qsizetype uploaded = 0;
+
+    QBENCHMARK {
+        ipset = QStringLiteral("bench%1").arg(++m_nextIPSet);
+        const QVariantMap result = importList(text, ipset, &uploaded);
+        QVERIFY2(result.value("ok").toBool(), qPrintable(result.value("message").toString()));
+    }
+
+    // Filled in chunks, each reported, and bound to the zone
+    QCOMPARE(uploaded, qsizetype(addresses));
+    QCOMPARE(m_mock->ipset(ipset).entries.size(), addresses);
+    QVERIFY(m_mock->permanentZone(BENCH_ZONE).sources.contains("ipset:" + ipset));
+}
+
+void BackendBenchmark::importExtendsExistingSet()
+{
+    QVERIFY(loadRules(10));
+    const QString ipset = QStringLiteral("bench%1").arg(++m_nextIPSet);
+
+    QVariantMap result = importList(sourceListText(70000), ipset);
+    QVERIFY2(result.value("ok").toBool(), qPrintable(result.value("message").toString()));
+
+    // Half overlaps; the set has to grow past the maxelem it was made with
+    qsizetype uploaded = 0;
+    result = importList(sourceListText(70000, 35000), ipset, &uploaded);
+    QVERIFY2(result.value("ok").toBool(), qPrintable(result.value("message").toString()));
+
+    const IPSetSettings settings = m_mock->ipset(ipset);
+    QCOMPARE(uploaded, qsizetype(35000));
+    QCOMPARE(settings.entries.size(), 105000);
+    QCOMPARE(settings.options.value("maxelem"), QStringLiteral("105000"));
+}
+
+void BackendBenchmark::deniedLogIngest_data()
+{
+    QTest::addColumn<int>("sources");
+    QTest::newRow("100 sources") << 100;
+    QTest::newRow("100k sources") << 100000; // every summary slot keeps getting evicted
+}
+
+void BackendBenchmark::deniedLogIngest()
+{
+    QFETCH(int, sources);
+
+    const QByteArray text = deniedLogText(LOG_LINES, sources);
+    const auto store = std::make_unique<DeniedLogStore>(); // the ring is too big for the stack
+
+    // 100k lines/s is a scan flooding the log; one pass must fit in a second
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(store->feed(text.constData(), text.size(), 0), text.size());
+    const qint64 elapsed = timer.elapsed();
+    QVERIFY2(elapsed < 1000, qPrintable(QStringLiteral("%1 lines took %2 ms").arg(LOG_LINES).arg(elapsed)));
+
+    QBENCHMARK {
+        store->feed(text.constData(), text.size(), 0);
+    }
+
+    const DeniedLogStore::Snapshot snapshot = store->snapshot(0, 10, 3);
+    QCOMPARE(snapshot.packets.size(), 10);
+    QCOMPARE(snapshot.ports.size(), 3);
+    QCOMPARE(snapshot.zones.value(0).key, QStringLiteral("public"));
+}
+
+QTEST_GUILESS_MAIN(BackendBenchmark)
+
+#include "backendbenchmark.moc"
@@ -0,0 +1,531 @@
+#include "mockfirewalld.h"
+
+#include <QDBusArgument>
+#include <QDBusMetaType>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
+#include <QMutexLocker>
+#include <QTimer>
+
+#include <utility>
+
+const QString FW_SERVICE = "org.fedoraproject.FirewallD1";
+const QString FW_PATH = "/org/fedoraproject/FirewallD1";
+const QString FW_INTERFACE = "org.fedoraproject.FirewallD1";
+const QString FW_ZONE_INTERFACE = "org.fedoraproject.FirewallD1.zone";
+const QString FW_CONFIG_PATH = "/org/fedoraproject/FirewallD1/config";
+const QString FW_CONFIG_INTERFACE = "org.fedoraproject.FirewallD1.config";
+const QString FW_CONFIG_ZONE_INTERFACE = "org.fedoraproject.FirewallD1.config.zone";
+const QString FW_CONFIG_IPSET_INTERFACE = "org.fedoraproject.FirewallD1.config.ipset";
+const QString FW_ZONE_PATH_PREFIX = "/org/fedoraproject/FirewallD1/config/zone/";
+const QString FW_IPSET_PATH_PREFIX = "/org/fedoraproject/FirewallD1/config/ipset/";
+const QString FW_EXCEPTION = "org.fedoraproject.FirewallD1.Exception";
+const QString PROPERTIES_INTERFACE = "org.freedesktop.DBus.Properties";
+
+const QString MOCK_VERSION = "2.3.1";
+
+// === MEMBER EDITS ===
+// Runtime zone and config.zone alike; empty on success, else the firewalld error code
+
+template <typename T>
+static QString addEntry(QList<T> &list, const T &entry)
+{
+    if (list.contains(entry)) return QStringLiteral("ALREADY_ENABLED");
+    list.append(entry);
+    return QString();
+}
+
+template <typename T>
+static QString removeEntry(QList<T> &list, const T &entry)
+{
+    return list.removeAll(entry) > 0 ? QString() : QStringLiteral("NOT_ENABLED");
+}
+
+static QString setFlag(bool &flag, bool enabled)
+{
+    if (flag == enabled) return enabled ? QStringLiteral("ALREADY_ENABLED") : QStringLiteral("NOT_ENABLED");
+    flag = enabled;
+    return QString();
+}
+
+static QString applyEdit(ZoneSettings &z, const QString &method, const QVariantList &args)
+{
+    const auto s = [&args](int i) { return args.value(i).toString(); };
+
+    if (method == "addService") return addEntry(z.services, s(0));
+    if (method == "removeService") return removeEntry(z.services, s(0));
+    if (method == "addPort") return addEntry(z.ports, ZonePort{s(0), s(1)});
+    if (method == "removePort") return removeEntry(z.ports, ZonePort{s(0), s(1)});
+    if (method == "addSource") return addEntry(z.sources, s(0));
+    if (method == "removeSource") return removeEntry(z.sources, s(0));
+    if (method == "addForwardPort") return addEntry(z.forwardPorts, ForwardPort{s(0), s(1), s(2), s(3)});
+    if (method == "removeForwardPort") return removeEntry(z.forwardPorts, ForwardPort{s(0), s(1), s(2), s(3)});
+    if (method == "addIcmpBlock") return addEntry(z.icmpBlocks, s(0));
+    if (method == "removeIcmpBlock") return removeEntry(z.icmpBlocks, s(0));
+    if (method == "addMasquerade") return setFlag(z.masquerade, true);
+    if (method == "removeMasquerade") return setFlag(z.masquerade, false);
+    if (method == "addIcmpBlockInversion") return setFlag(z.icmpBlockInversion, true);
+    if (method == "removeIcmpBlockInversion") return setFlag(z.icmpBlockInversion, false);
+    if (method == "setTarget") {
+        z.target = s(0);
+        return QString();
+    }
+    return QStringLiteral("UNKNOWN_METHOD");
+}
+
+// Runtime adds that take a timeout as their last argument
+static bool takesTimeout(const QString &method)
+{
+    return method == "addService" || method == "addPort" || method == "addForwardPort"
+        || method == "addMasquerade" || method == "addIcmpBlock";
+}
+
+// addPort -> PortAdded, removeSource -> SourceRemoved
+static QString runtimeSignalName(const QString &method)
+{
+    if (method.startsWith("add")) return method.mid(3) + "Added";
+    return method.mid(6) + "Removed";
+}
+
+// update2 leaves every key it isn't given untouched
+static void mergeSettings(ZoneSettings &z, const QVariantMap &map)
+{
+    const ZoneSettings from = ZoneSettings::fromVariantMap(map);
+
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        const QString &key = it.key();
+        if (key == "short") z.shortName = from.shortName;
+        else if (key == "description") z.description = from.description;
+        else if (key == "target") z.target = from.target;
+        else if (key == "services") z.services = from.services;
+        else if (key == "ports") z.ports = from.ports;
+        else if (key == "icmp_blocks") z.icmpBlocks = from.icmpBlocks;
+        else if (key == "masquerade") z.masquerade = from.masquerade;
+        else if (key == "forward_ports") z.forwardPorts = from.forwardPorts;
+        else if (key == "interfaces") z.interfaces = from.interfaces;
+        else if (key == "sources") z.sources = from.sources;
+        else if (key == "rules_str") z.richRules = from.richRules;
+        else if (key == "protocols") z.protocols = from.protocols;
+        else if (key == "source_ports") z.sourcePorts = from.sourcePorts;
+        else if (key == "icmp_block_inversion") z.icmpBlockInversion = from.icmpBlockInversion;
+    }
+}
+
+static QDBusMessage firewallError(const QDBusMessage &message, const QString &code, const QString &detail)
+{
+    return message.createErrorReply(FW_EXCEPTION, code + ": " + detail);
+}
+
+// === SETUP ===
+
+MockFirewallD::MockFirewallD(QObject *parent)
+    : QDBusVirtualObject(parent)
+{
+    registerZoneSettingsTypes();
+    qDBusRegisterMetaType<IPSetSettings>();
+
+    m_services = {
+        {"ssh", {{"22", "tcp"}}},
+        {"http", {{"80", "tcp"}}},
+        {"https", {{"443", "tcp"}}},
+        {"dns", {{"53", "tcp"}, {"53", "udp"}}},
+        {"mdns", {{"5353", "udp"}}},
+        {"dhcpv6-client", {{"546", "udp"}}},
+    };
+}
+
+MockFirewallD::~MockFirewallD()
+{
+    if (m_connectionName.isEmpty()) return;
+
+    QDBusConnection bus(m_connectionName);
+    bus.unregisterObject(FW_PATH, QDBusConnection::UnregisterTree);
+    bus.unregisterService(FW_SERVICE);
+    QDBusConnection::disconnectFromBus(m_connectionName);
+}
+
+bool MockFirewallD::start(const QString &address)
+{
+    m_connectionName = QStringLiteral("mockfirewalld");
+
+    QDBusConnection bus = QDBusConnection::connectToBus(address, m_connectionName);
+    if (!bus.isConnected()) return false;
+
+    // One object for the whole tree: the config path and every zone under it
+    return bus.registerVirtualObject(FW_PATH, this, QDBusConnection::SubPath)
+        && bus.registerService(FW_SERVICE);
+}
+
+void MockFirewallD::setZones(const QHash<QString, ZoneSettings> &zones, const QString &defaultZone)
+{
+    QMutexLocker lock(&m_mutex);
+    m_permanent = zones;
+    m_runtime = zones;
+    m_zoneOrder = zones.keys();
+    m_zoneOrder.sort();
+    m_defaultZone = defaultZone;
+}
+
+ZoneSettings MockFirewallD::permanentZone(const QString &zone) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_permanent.value(zone);
+}
+
+ZoneSettings MockFirewallD::runtimeZone(const QString &zone) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_runtime.value(zone);
+}
+
+IPSetSettings MockFirewallD::ipset(const QString &name) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_ipsets.value(name);
+}
+
+void MockFirewallD::setDelay(int ms)
+{
+    QMutexLocker lock(&m_mutex);
+    m_delayMs = ms;
+}
+
+void MockFirewallD::setDelay(const QString &method, int ms)
+{
+    QMutexLocker lock(&m_mutex);
+    m_methodDelays.insert(method, ms);
+}
+
+int MockFirewallD::callCount(const QString &method) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_calls.value(method);
+}
+
+void MockFirewallD::resetCallCounts()
+{
+    QMutexLocker lock(&m_mutex);
+    m_calls.clear();
+}
+
+QString MockFirewallD::zonePath(const QString &zone) const
+{
+    return FW_ZONE_PATH_PREFIX + QString::number(m_zoneOrder.indexOf(zone));
+}
+
+QString MockFirewallD::ipsetPath(const QString &name) const
+{
+    return FW_IPSET_PATH_PREFIX + QString::number(m_ipsetOrder.indexOf(name));
+}
+
+// Clients here use generated proxies and never introspect
+QString MockFirewallD::introspect(const QString &) const
+{
+    return QString();
+}
+
+// === DISPATCH ===
+
+bool MockFirewallD::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    if (message.type() != QDBusMessage::MethodCallMessage) return false;
+
+    Outcome outcome;
+    int delayMs = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_calls[message.member()]++;
+        outcome = dispatch(message);
+        delayMs = m_methodDelays.value(message.member(), m_delayMs);
+    }
+
+    if (delayMs <= 0) {
+        deliver(connection, outcome);
+    } else {
+        QTimer::singleShot(delayMs, this, [this, connection, outcome]() { deliver(connection, outcome); });
+    }
+    return true;
+}
+
+void MockFirewallD::deliver(const QDBusConnection &connection, const Outcome &outcome)
+{
+    // firewalld emits while handling the call, so its signals beat the reply
+    for (const QDBusMessage &event : outcome.events) connection.send(event);
+    connection.send(outcome.reply);
+
+    switch (outcome.change) {
+    case NoChange:
+        break;
+    case RuntimeChange:
+        emit runtimeChanged(outcome.zone);
+        break;
+    case PermanentChange:
+        emit permanentChanged(outcome.zone);
+        break;
+    case ReloadChange:
+        emit reloaded();
+        break;
+    }
+}
+
+MockFirewallD::Outcome MockFirewallD::dispatch(const QDBusMessage &message)
+{
+    const QString path = message.path();
+    const QString interface = message.interface();
+
+    if (path == FW_PATH && interface == FW_INTERFACE) return callMain(message);
+    if (path == FW_PATH && interface == FW_ZONE_INTERFACE) return callRuntimeZone(message);
+    if (path == FW_PATH && interface == PROPERTIES_INTERFACE) return callProperties(message);
+    if (path == FW_CONFIG_PATH && interface == FW_CONFIG_INTERFACE) return callConfig(message);
+    if (path.startsWith(FW_ZONE_PATH_PREFIX) && interface == FW_CONFIG_ZONE_INTERFACE) return callConfigZone(message);
+    if (path.startsWith(FW_IPSET_PATH_PREFIX) && interface == FW_CONFIG_IPSET_INTERFACE) return callConfigIPSet(message);
+
+    Outcome out;
+    out.reply = message.createErrorReply(QDBusError::UnknownMethod,
+                                         "No such method " + interface + "." + message.member() + " on " + path);
+    return out;
+}
+
+MockFirewallD::Outcome MockFirewallD::callMain(const QDBusMessage &message)
+{
+    const QString method = message.member();
+    const QVariantList args = message.arguments();
+    Outcome out;
+
+    if (method == "getDefaultZone") {
+        out.reply = message.createReply(m_defaultZone);
+    } else if (method == "setDefaultZone") {
+        const QString zone = args.value(0).toString();
+        if (!m_permanent.contains(zone)) {
+            out.reply = firewallError(message, "INVALID_ZONE", zone);
+        } else {
+            m_defaultZone = zone;
+            out.reply = message.createReply();
+            out.events.append(QDBusMessage::createSignal(FW_PATH, FW_INTERFACE, "DefaultZoneChanged") << zone);
+        }
+    } else if (method == "queryPanicMode") {
+        out.reply = message.createReply(m_panic);
+    } else if (method == "enablePanicMode" || method == "disablePanicMode") {
+        const bool enable = method == "enablePanicMode";
+        const QString error = setFlag(m_panic, enable);
+        if (!error.isEmpty()) {
+            out.reply = firewallError(message, error, "panic mode");
+        } else {
+            out.reply = message.createReply();
+            out.events.append(QDBusMessage::createSignal(FW_PATH, FW_INTERFACE,
+                                                         enable ? "PanicModeEnabled" : "PanicModeDisabled"));
+        }
+    } else if (method == "getLogDenied") {
+        out.reply = message.createReply(m_logDenied);
+    } else if (method == "setLogDenied") {
+        m_logDenied = args.value(0).toString();
+        out.reply = message.createReply();
+        out.events.append(QDBusMessage::createSignal(FW_PATH, FW_INTERFACE, "LogDeniedChanged") << m_logDenied);
+    } else if (method == "listServices") {
+        QStringList names = m_services.keys();
+        names.sort();
+        out.reply = message.createReply(names);
+    } else if (method == "getServiceSettings2") {
+        const QString name = args.value(0).toString();
+        auto service = m_services.constFind(name);
+        if (service == m_services.constEnd()) {
+            out.reply = firewallError(message, "INVALID_SERVICE", name);
+        } else {
+            QVariantMap settings{{"short", name.toUpper()}, {"ports", QVariant::fromValue(*service)}};
+            out.reply = message.createReply(settings);
+        }
+    } else if (method == "reload") {
+        m_runtime = m_permanent;
+        out.reply = message.createReply();
+        out.events.append(QDBusMessage::createSignal(FW_PATH, FW_INTERFACE, "Reloaded"));
+        out.change = ReloadChange;
+    } else {
+        out.reply = message.createErrorReply(QDBusError::UnknownMethod, "No such method " + method);
+    }
+
+    return out;
+}
+
+MockFirewallD::Outcome MockFirewallD::callRuntimeZone(const QDBusMessage &message)
+{
+    const QString method = message.member();
+    const QVariantList args = message.arguments();
+    const QString zone = args.value(0).toString();
+    Outcome out;
+
+    if (method == "getZones") {
+        out.reply = message.createReply(m_zoneOrder);
+        return out;
+    }
+
+    auto settings = m_runtime.find(zone);
+    if (settings == m_runtime.end()) {
+        out.reply = firewallError(message, "INVALID_ZONE", zone);
+        return out;
+    }
+
+    const int memberCount = args.size() - 1 - (takesTimeout(method) ? 1 : 0);
+    const QString error = applyEdit(*settings, method, args.mid(1, memberCount));
+    if (error == "UNKNOWN_METHOD") {
+        out.reply = message.createErrorReply(QDBusError::UnknownMethod, "No such method " + method);
+    } else if (!error.isEmpty()) {
+        out.reply = firewallError(message, error, zone);
+    } else {
+        // Signal arguments are the call's own: zone, members, then any timeout
+        QDBusMessage event = QDBusMessage::createSignal(FW_PATH, FW_ZONE_INTERFACE, runtimeSignalName(method));
+        event.setArguments(args);
+        out.events.append(event);
+        out.reply = message.createReply(zone);
+        out.change = RuntimeChange;
+        out.zone = zone;
+    }
+
+    return out;
+}
+
+MockFirewallD::Outcome MockFirewallD::callConfig(const QDBusMessage &message)
+{
+    const QString method = message.member();
+    const QString name = message.arguments().value(0).toString();
+    Outcome out;
+
+    if (method == "getZoneNames") {
+        out.reply = message.createReply(m_zoneOrder);
+    } else if (method == "listZones") {
+        QList<QDBusObjectPath> paths;
+        for (const QString &zone : std::as_const(m_zoneOrder)) paths.append(QDBusObjectPath(zonePath(zone)));
+        out.reply = message.createReply(QVariant::fromValue(paths));
+    } else if (method == "getZoneByName") {
+        if (!m_permanent.contains(name)) out.reply = firewallError(message, "INVALID_ZONE", name);
+        else out.reply = message.createReply(QVariant::fromValue(QDBusObjectPath(zonePath(name))));
+    } else if (method == "getIPSetByName") {
+        if (!m_ipsets.contains(name)) out.reply = firewallError(message, "INVALID_IPSET", name);
+        else out.reply = message.createReply(QVariant::fromValue(QDBusObjectPath(ipsetPath(name))));
+    } else if (method == "addIPSet") {
+        const IPSetSettings settings = qdbus_cast<IPSetSettings>(message.arguments().value(1));
+        if (m_ipsets.contains(name)) {
+            out.reply = firewallError(message, "NAME_CONFLICT", name);
+        } else if (settings.entries.size() > settings.options.value("maxelem", "65536").toLongLong()) {
+            out.reply = firewallError(message, "INVALID_ENTRY", "ipset is full");
+        } else {
+            m_ipsetOrder.append(name);
+            m_ipsets.insert(name, settings);
+            out.reply = message.createReply(QVariant::fromValue(QDBusObjectPath(ipsetPath(name))));
+            out.events.append(QDBusMessage::createSignal(FW_CONFIG_PATH, FW_CONFIG_INTERFACE, "IPSetAdded") << name);
+        }
+    } else {
+        out.reply = message.createErrorReply(QDBusError::UnknownMethod, "No such method " + method);
+    }
+
+    return out;
+}
+
+MockFirewallD::Outcome MockFirewallD::callConfigZone(const QDBusMessage &message)
+{
+    const QString method = message.member();
+    const QVariantList args = message.arguments();
+    Outcome out;
+
+    bool validIndex = false;
+    const int index = message.path().mid(FW_ZONE_PATH_PREFIX.size()).toInt(&validIndex);
+    if (!validIndex || index < 0 || index >= m_zoneOrder.size()) {
+        out.reply = message.createErrorReply(QDBusError::UnknownObject, "No such object " + message.path());
+        return out;
+    }
+
+    const QString zone = m_zoneOrder.at(index);
+    ZoneSettings &settings = m_permanent[zone];
+
+    if (method == "getSettings2") {
+        out.reply = message.createReply(settings.deltaFrom(ZoneSettings()));
+        return out;
+    }
+    if (method == "getTarget") {
+        out.reply = message.createReply(settings.target);
+        return out;
+    }
+
+    QString error;
+    if (method == "update2") mergeSettings(settings, qdbus_cast<QVariantMap>(args.value(0)));
+    else error = applyEdit(settings, method, args);
+
+    if (error == "UNKNOWN_METHOD") {
+        out.reply = message.createErrorReply(QDBusError::UnknownMethod, "No such method " + method);
+    } else if (!error.isEmpty()) {
+        out.reply = firewallError(message, error, zone);
+    } else {
+        out.events.append(QDBusMessage::createSignal(message.path(), FW_CONFIG_ZONE_INTERFACE, "Updated") << zone);
+        out.reply = message.createReply();
+        out.change = PermanentChange;
+        out.zone = zone;
+    }
+
+    return out;
+}
+
+// Only what an import uses; entries are checked against maxelem as firewalld does
+MockFirewallD::Outcome MockFirewallD::callConfigIPSet(const QDBusMessage &message)
+{
+    const QString method = message.member();
+    const QVariantList args = message.arguments();
+    Outcome out;
+
+    bool validIndex = false;
+    const int index = message.path().mid(FW_IPSET_PATH_PREFIX.size()).toInt(&validIndex);
+    if (!validIndex || index < 0 || index >= m_ipsetOrder.size()) {
+        out.reply = message.createErrorReply(QDBusError::UnknownObject, "No such object " + message.path());
+        return out;
+    }
+
+    const QString name = m_ipsetOrder.at(index);
+    IPSetSettings &settings = m_ipsets[name];
+    const qsizetype maxelem = settings.options.value("maxelem", "65536").toLongLong();
+
+    if (method == "getSettings") {
+        out.reply = message.createReply(QVariant::fromValue(settings));
+        return out;
+    }
+    if (method == "getEntries") {
+        out.reply = message.createReply(settings.entries);
+        return out;
+    }
+
+    QString error;
+    if (method == "setEntries") {
+        const QStringList entries = args.value(0).toStringList();
+        if (entries.size() > maxelem) error = "INVALID_ENTRY";
+        else settings.entries = entries;
+    } else if (method == "addEntry") {
+        if (settings.entries.size() >= maxelem) error = "INVALID_ENTRY";
+        else error = addEntry(settings.entries, args.value(0).toString());
+    } else if (method == "addOption") {
+        const QString key = args.value(0).toString();
+        const QString value = args.value(1).toString();
+        if (settings.options.contains(key) && settings.options.value(key) == value) error = "ALREADY_ENABLED";
+        else settings.options.insert(key, value);
+    } else {
+        out.reply = message.createErrorReply(QDBusError::UnknownMethod, "No such method " + method);
+        return out;
+    }
+
+    if (!error.isEmpty()) {
+        out.reply = firewallError(message, error, name);
+    } else {
+        out.events.append(QDBusMessage::createSignal(message.path(), FW_CONFIG_IPSET_INTERFACE, "Updated") << name);
+        out.reply = message.createReply();
+    }
+    return out;
+}
+
+MockFirewallD::Outcome MockFirewallD::callProperties(const QDBusMessage &message)
+{
+    const QVariantList args = message.arguments();
+    Outcome out;
+
+    if (message.member() == "Get" && args.value(0).toString() == FW_INTERFACE && args.value(1).toString() == "version")
+        out.reply = message.createReply(QVariant::fromValue(QDBusVariant(MOCK_VERSION)));
+    else
+        out.reply = message.createErrorReply(QDBusError::InvalidArgs, "Property not mocked");
+
+    return out;
+}
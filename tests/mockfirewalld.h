@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusVirtualObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include "sourceimport.h"
+#include "zonesettings.h"
+
+// In-process stand-in for org.fedoraproject.FirewallD1, run on its own thread.
+// Replies can be held back to play a slow daemon.
+class MockFirewallD : public QDBusVirtualObject
+{
+    Q_OBJECT
+
+public:
+    explicit MockFirewallD(QObject *parent = nullptr);
+    ~MockFirewallD() override;
+
+    // Claims the firewalld name on the bus at `address`; call on the mock's thread
+    bool start(const QString &address);
+
+    // Replaces every zone, permanent and runtime alike, without sending signals
+    void setZones(const QHash<QString, ZoneSettings> &zones, const QString &defaultZone);
+    ZoneSettings permanentZone(const QString &zone) const;
+    ZoneSettings runtimeZone(const QString &zone) const;
+    // Permanent ipsets; an empty shortName when there is no such set
+    IPSetSettings ipset(const QString &name) const;
+
+    // Milliseconds every reply (and the signals it causes) is held back
+    void setDelay(int ms);
+    // The same for one method, by member name; wins over setDelay(int)
+    void setDelay(const QString &method, int ms);
+
+    int callCount(const QString &method) const;
+    void resetCallCounts();
+
+    QString introspect(const QString &path) const override;
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override;
+
+signals:
+    // Sent along with the reply, so they arrive after the client's signals
+    void runtimeChanged(const QString &zone);
+    void permanentChanged(const QString &zone);
+    void reloaded();
+
+private:
+    enum Change { NoChange, RuntimeChange, PermanentChange, ReloadChange };
+
+    // One call's reply, the signals sent before it, and the in-process signal after
+    struct Outcome {
+        QDBusMessage reply;
+        QList<QDBusMessage> events;
+        Change change = NoChange;
+        QString zone;
+    };
+
+    // All called with m_mutex held
+    Outcome dispatch(const QDBusMessage &message);
+    Outcome callMain(const QDBusMessage &message);
+    Outcome callRuntimeZone(const QDBusMessage &message);
+    Outcome callConfig(const QDBusMessage &message);
+    Outcome callConfigZone(const QDBusMessage &message);
+    Outcome callConfigIPSet(const QDBusMessage &message);
+    Outcome callProperties(const QDBusMessage &message);
+    QString zonePath(const QString &zone) const;
+    QString ipsetPath(const QString &name) const;
+
+    void deliver(const QDBusConnection &connection, const Outcome &outcome);
+
+    mutable QMutex m_mutex;
+    QString m_connectionName;
+
+    QStringList m_zoneOrder; // index is the object path suffix, as in firewalld
+    QHash<QString, ZoneSettings> m_permanent;
+    QHash<QString, ZoneSettings> m_runtime;
+    QString m_defaultZone;
+    bool m_panic = false;
+    QString m_logDenied = QStringLiteral("off");
+    QHash<QString, QList<ZonePort>> m_services;
+    QStringList m_ipsetOrder; // as m_zoneOrder
+    QHash<QString, IPSetSettings> m_ipsets;
+
+    int m_delayMs = 0;
+    QHash<QString, int> m_methodDelays;
+    QHash<QString, int> m_calls;
+};
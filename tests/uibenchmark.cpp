@@ -0,0 +1,140 @@
+// The window offscreen; ctest also runs it with QML_DISABLE_DISK_CACHE=1 to compare
+//
+//     ctest -R uibenchmark --verbose
+//     QT_QPA_PLATFORM=offscreen ./uibenchmark -median 5 timeToFirstFrame
+
+#include <QQmlApplicationEngine>
+#include <QQmlContext>
+#include <QQmlExtensionPlugin>
+#include <QQuickWindow>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <KLocalizedContext>
+#include <MauiKit4/Core/mauiapp.h>
+
+#include <memory>
+
+#include "firewallbackend.h"
+#include "rulelistmodel.h"
+#include "socketinventory.h"
+#include "zonesettings.h"
+
+Q_IMPORT_QML_PLUGIN(org_nitrux_firewallPlugin)
+
+const int FRAME_TIMEOUT_MS = 10000;
+
+// `count` distinct ports; `protocol` makes two zones share none of them
+static ZoneSettings zoneWithPorts(int count, const QString &protocol)
+{
+    ZoneSettings zone;
+    zone.ports.reserve(count);
+    for (int i = 0; i < count; ++i) zone.ports.append({QString::number(1 + i), protocol});
+    return zone;
+}
+
+// A listener on every other port, so half the rows flip between the two labels
+static SocketTablePtr socketsFor(int count, int offset)
+{
+    auto table = QSharedPointer<SocketTable>::create();
+    for (int port = 1 + offset; port <= count; port += 2) {
+        Listener listener;
+        listener.port = quint16(port);
+        listener.address = QStringLiteral("0.0.0.0");
+        listener.pid = 1000 + port;
+        listener.process = QStringLiteral("bench");
+        table->tcp.push_back(listener);
+    }
+    return table;
+}
+
+static bool waitForFrame(QQuickWindow *window)
+{
+    QSignalSpy frames(window, &QQuickWindow::frameSwapped);
+    window->update();
+    return frames.wait(FRAME_TIMEOUT_MS);
+}
+
+class UiBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    // New engine, Main loaded from the module, until the window has drawn once
+    void timeToFirstFrame();
+
+    // A zone swap where every rule changes, then a new socket table; each until the next frame
+    void ruleBindings_data();
+    void ruleBindings();
+
+private:
+    std::unique_ptr<QQmlApplicationEngine> load(QQuickWindow *&window);
+};
+
+void UiBenchmark::initTestCase()
+{
+    // Same setup as main.cpp, minus what only matters on a real desktop
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    MauiApp::instance();
+}
+
+std::unique_ptr<QQmlApplicationEngine> UiBenchmark::load(QQuickWindow *&window)
+{
+    auto engine = std::make_unique<QQmlApplicationEngine>();
+    engine->rootContext()->setContextObject(new KLocalizedContext(engine.get()));
+    engine->loadFromModule("org.nitrux.firewall", "Main");
+
+    window = qobject_cast<QQuickWindow *>(engine->rootObjects().value(0));
+    if (window && !window->isVisible()) window->show();
+    return engine;
+}
+
+void UiBenchmark::timeToFirstFrame()
+{
+    QBENCHMARK {
+        QQuickWindow *window = nullptr;
+        const std::unique_ptr<QQmlApplicationEngine> engine = load(window);
+        QVERIFY2(window, "Main did not load");
+        QVERIFY(waitForFrame(window));
+    }
+}
+
+void UiBenchmark::ruleBindings_data()
+{
+    QTest::addColumn<int>("rules");
+    QTest::newRow("10 rules") << 10;
+    QTest::newRow("1k rules") << 1000;
+}
+
+void UiBenchmark::ruleBindings()
+{
+    QFETCH(int, rules);
+
+    QQuickWindow *window = nullptr;
+    const std::unique_ptr<QQmlApplicationEngine> engine = load(window);
+    QVERIFY2(window, "Main did not load");
+    QVERIFY(waitForFrame(window));
+
+    auto *backend = window->findChild<FirewallBackend *>();
+    QVERIFY2(backend, "no FirewallBackend in Main");
+    RuleListModel *model = backend->rules();
+
+    const ZoneSettings zones[2] = {zoneWithPorts(rules, "tcp"), zoneWithPorts(rules, "udp")};
+    const SocketTablePtr sockets[2] = {socketsFor(rules, 0), socketsFor(rules, 1)};
+    const PortIndex::ServicePorts noServices = [](const QString &) { return QList<ZonePort>(); };
+
+    int turn = 0;
+    QBENCHMARK {
+        model->setZone(zones[turn]);
+        QVERIFY(waitForFrame(window));
+        model->setListeners(sockets[turn], noServices);
+        QVERIFY(waitForFrame(window));
+        turn ^= 1;
+    }
+}
+
+QTEST_MAIN(UiBenchmark)
+
+#include "uibenchmark.moc"